@@ -132,6 +132,8 @@ void Configuration::ReadValues() {
     
     // Core
     ReadSetting("Core", Settings::values.use_cpu_jit);
+    ReadSetting("Core", Settings::values.parallel_cpu_cores);
+    ReadSetting("Core", Settings::values.skip_idle_loops);
     ReadSetting("Core", Settings::values.cpu_clock_percentage);
     
     // Renderer
@@ -144,6 +146,10 @@ void Configuration::ReadValues() {
     ReadSetting("Renderer", Settings::values.spirv_shader_gen);
     ReadSetting("Renderer", Settings::values.use_hw_shader);
     ReadSetting("Renderer", Settings::values.use_shader_jit);
+    ReadSetting("Renderer", Settings::values.async_shader_jit);
+    ReadSetting("Renderer", Settings::values.shader_jit_cache_size);
+    ReadSetting("Renderer", Settings::values.vertex_cache_size);
+    ReadSetting("Renderer", Settings::values.parallel_vertex_shading);
     ReadSetting("Renderer", Settings::values.resolution_factor);
     ReadSetting("Renderer", Settings::values.use_disk_shader_cache);
     ReadSetting("Renderer", Settings::values.use_vsync_new);
@@ -220,6 +226,8 @@ void Configuration::ReadValues() {
     ReadSetting("Utility", Settings::values.custom_textures);
     ReadSetting("Utility", Settings::values.preload_textures);
     ReadSetting("Utility", Settings::values.async_custom_loading);
+    ReadSetting("Utility", Settings::values.cache_custom_textures);
+    ReadSetting("Utility", Settings::values.texture_prefetch_size);
     
     // Audio
     ReadSetting("Audio", Settings::values.audio_emulation);
@@ -94,6 +94,16 @@ use_artic_base_controller=
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_cpu_jit =
 
+# Whether to run each emulated CPU core on its own host thread. Only used with the JIT on systems
+# with more than one core (New 3DS). Can improve performance but is experimental.
+# 0 (default): Off, 1: On
+parallel_cpu_cores =
+
+# Whether to skip ahead to the next event when the emulated CPU waits in an idle loop or for an
+# interrupt. Reduces host CPU usage in games that busy-wait, but changes the emulated timing.
+# 0 (default): Off, 1: On
+skip_idle_loops =
+
 # Change the Clock Frequency of the emulated 3DS CPU.
 # Underclocking can increase the performance of the game at the risk of freezing.
 # Overclocking may fix lag that happens on console, but also comes with the risk of freezing.
@@ -125,6 +135,22 @@ shaders_accurate_mul =
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_shader_jit =
 
+# Whether to compile new shaders in the background and interpret them until the JIT code is ready
+# 0 (default): Off, 1: On
+async_shader_jit =
+
+# Executable memory in MiB the shader JIT may use before freeing least recently used shaders
+# 16 - 2048: Budget in MiB (default: 128)
+shader_jit_cache_size =
+
+# Number of post-transform vertices cached during indexed draws when shading on the CPU.
+# Rounded up to a power of two. 16 - 4096, default: 256
+vertex_cache_size =
+
+# Whether to split large draws across multiple threads when shading vertices on the CPU
+# 0 (default): Off, 1: On
+parallel_vertex_shading =
+
 # Overrides the sampling filter used by games. This can be useful in certain
 # cases with poorly behaved games when upscaling.
 # 0 (default): Game Controlled, 1: Nearest Neighbor, 2: Linear
@@ -291,6 +317,15 @@ preload_textures =
 # 0: Off, 1 (default): On
 async_custom_loading =
 
+# Stores decoded PNG custom textures in cache/custom_textures/ so later loads skip PNG decoding.
+# 0 (default): Off, 1: On
+cache_custom_textures =
+
+# Memory in MiB custom textures may occupy when loaded ahead of demand, in the order in which the
+# title requested them before. Textures that are skipped by the title are freed again.
+# 0: Off, 1 - 1024: Budget in MiB (default: 128)
+texture_prefetch_size =
+
 [Audio]
 # Whether or not to enable DSP LLE
 # 0 (default): No, 1: Yes
@@ -413,6 +413,30 @@ u64 GetSize(const std::string& filename) {
     return 0;
 }
 
+u64 GetModificationTime(const std::string& filename) {
+#ifdef ANDROID
+    // Storage access framework paths do not expose modification times.
+    return 0;
+#else
+    std::string copy(filename);
+    StripTailDirSlashes(copy);
+
+#ifdef _WIN32
+    struct _stat64 buf;
+    const int result = _wstat64(Common::UTF8ToUTF16W(copy).c_str(), &buf);
+#else
+    struct stat buf;
+    const int result = stat(copy.c_str(), &buf);
+#endif
+
+    if (result != 0) {
+        LOG_DEBUG(Common_Filesystem, "Stat failed {}: {}", filename, GetLastErrorMsg());
+        return 0;
+    }
+    return static_cast<u64>(buf.st_mtime);
+#endif
+}
+
 u64 GetSize(const int fd) {
     struct stat buf;
     if (fstat(fd, &buf) != 0) {
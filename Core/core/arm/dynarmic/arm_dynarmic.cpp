@@ -7,6 +7,7 @@
 #include <dynarmic/interface/optimization_flags.h>
 #include "common/assert.h"
 #include "common/microprofile.h"
+#include "common/settings.h"
 #include "core/arm/dynarmic/arm_dynarmic.h"
 #include "core/arm/dynarmic/arm_dynarmic_cp15.h"
 #include "core/arm/dynarmic/arm_exclusive_monitor.h"
@@ -26,41 +27,53 @@ public:
     ~DynarmicUserCallbacks() = default;
 
     std::uint8_t MemoryRead8(VAddr vaddr) override {
+        const auto lock = parent.system.LockCore(parent);
         return memory.Read8(vaddr);
     }
     std::uint16_t MemoryRead16(VAddr vaddr) override {
+        const auto lock = parent.system.LockCore(parent);
         return memory.Read16(vaddr);
     }
     std::uint32_t MemoryRead32(VAddr vaddr) override {
+        const auto lock = parent.system.LockCore(parent);
         return memory.Read32(vaddr);
     }
     std::uint64_t MemoryRead64(VAddr vaddr) override {
+        const auto lock = parent.system.LockCore(parent);
         return memory.Read64(vaddr);
     }
 
     void MemoryWrite8(VAddr vaddr, std::uint8_t value) override {
+        const auto lock = parent.system.LockCore(parent);
         memory.Write8(vaddr, value);
     }
     void MemoryWrite16(VAddr vaddr, std::uint16_t value) override {
+        const auto lock = parent.system.LockCore(parent);
         memory.Write16(vaddr, value);
     }
     void MemoryWrite32(VAddr vaddr, std::uint32_t value) override {
+        const auto lock = parent.system.LockCore(parent);
         memory.Write32(vaddr, value);
     }
     void MemoryWrite64(VAddr vaddr, std::uint64_t value) override {
+        const auto lock = parent.system.LockCore(parent);
         memory.Write64(vaddr, value);
     }
 
     bool MemoryWriteExclusive8(u32 vaddr, u8 value, u8 expected) override {
+        const auto lock = parent.system.LockCore(parent);
         return memory.WriteExclusive8(vaddr, value, expected);
     }
     bool MemoryWriteExclusive16(u32 vaddr, u16 value, u16 expected) override {
+        const auto lock = parent.system.LockCore(parent);
         return memory.WriteExclusive16(vaddr, value, expected);
     }
     bool MemoryWriteExclusive32(u32 vaddr, u32 value, u32 expected) override {
+        const auto lock = parent.system.LockCore(parent);
         return memory.WriteExclusive32(vaddr, value, expected);
     }
     bool MemoryWriteExclusive64(u32 vaddr, u64 value, u64 expected) override {
+        const auto lock = parent.system.LockCore(parent);
         return memory.WriteExclusive64(vaddr, value, expected);
     }
 
@@ -71,6 +84,7 @@ public:
     }
 
     void CallSVC(std::uint32_t swi) override {
+        const auto lock = parent.system.LockCore(parent);
         svc_context.CallSVC(swi);
     }
 
@@ -89,10 +103,16 @@ public:
                 return;
             }
             break;
-        case Dynarmic::A32::Exception::SendEvent:
-        case Dynarmic::A32::Exception::SendEventLocal:
         case Dynarmic::A32::Exception::WaitForInterrupt:
         case Dynarmic::A32::Exception::WaitForEvent:
+            // Nothing happens until the next event, so skip the rest of the slice.
+            if (Settings::values.skip_idle_loops.GetValue() && !GDBStub::IsServerEnabled()) {
+                parent.GetTimer().Idle();
+                parent.jit->HaltExecution();
+            }
+            return;
+        case Dynarmic::A32::Exception::SendEvent:
+        case Dynarmic::A32::Exception::SendEventLocal:
         case Dynarmic::A32::Exception::Yield:
         case Dynarmic::A32::Exception::PreloadData:
         case Dynarmic::A32::Exception::PreloadDataWithIntentToWrite:
@@ -136,7 +156,8 @@ ARM_Dynarmic::~ARM_Dynarmic() = default;
 MICROPROFILE_DEFINE(ARM_Jit, "ARM JIT", "ARM JIT", MP_RGB(255, 64, 64));
 
 void ARM_Dynarmic::Run() {
-    ASSERT(memory.GetCurrentPageTable() == current_page_table);
+    // With parallel cores the memory system follows whichever core last entered the kernel.
+    ASSERT(system.RunsCoresInParallel() || memory.GetCurrentPageTable() == current_page_table);
     MICROPROFILE_SCOPE(ARM_Jit);
 
     jit->Run();
@@ -309,6 +330,8 @@ std::unique_ptr<Dynarmic::A32::Jit> ARM_Dynarmic::MakeJit() {
     }
     config.coprocessors[15] = std::make_shared<DynarmicCP15>(cp15_state);
     config.define_unpredictable_behaviour = true;
+    // Hint instructions end the block when hooked, so only do so when idle loops are skipped.
+    config.hook_hint_instructions = Settings::values.skip_idle_loops.GetValue();
 
     // Multi-process state
     config.processor_id = GetID();
@@ -9,6 +9,7 @@
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/settings.h"
 #include "core/arm/dyncom/arm_dyncom_dec.h"
 #include "core/arm/dyncom/arm_dyncom_interpreter.h"
 #include "core/arm/dyncom/arm_dyncom_run.h"
@@ -805,6 +806,60 @@ static ThumbDecodeStatus DecodeThumbInstruction(u32 inst, u32 addr, u32* arm_ins
 
 enum { KEEP_GOING, FETCH_EXCEPTION };
 
+// Superinstructions, whose labels follow the DISPATCH, INIT_INST_LENGTH and END labels
+enum : unsigned {
+    CMP_BBL_IDX = arm_instruction_trans_len + 3,
+    TST_BBL_IDX,
+    LDR_CMP_IDX,
+    ADD_LDM_IDX,
+};
+
+/**
+ * Turns the first instruction into a superinstruction if it forms a common pair with the next
+ * one: compare and branch, load and compare, or the stack adjustment before a pop. The
+ * superinstruction runs the first instruction without checking its condition and continues
+ * directly with the next one, skipping the dispatch in between.
+ *
+ * Condition checks are not precomputed for longer unconditional runs. Every handler tests for
+ * ConditionCode::AL before calling CondPassed, which costs the same single compare a
+ * precomputed flag would, so only the checks skipped by fusion are saved.
+ */
+static void FuseInstructions(ARMul_State* cpu, u32 first, u32 second) {
+    arm_inst* const inst = reinterpret_cast<arm_inst*>(cpu->translation_cache.Pointer(first));
+    const arm_inst* const next =
+        reinterpret_cast<const arm_inst*>(cpu->translation_cache.Pointer(second));
+    if (inst->cond != ConditionCode::AL || inst->br != TransExtData::NON_BRANCH) {
+        return;
+    }
+
+    switch (inst->idx) {
+    case CMP_IDX:
+        if (next->idx == BBL_IDX) {
+            inst->idx = CMP_BBL_IDX;
+        }
+        break;
+    case TST_IDX:
+        if (next->idx == BBL_IDX) {
+            inst->idx = TST_BBL_IDX;
+        }
+        break;
+    case LDR_IDX:
+        if (next->idx == CMP_IDX) {
+            inst->idx = LDR_CMP_IDX;
+        }
+        break;
+    case ADD_IDX: {
+        const add_inst* const inst_cream = reinterpret_cast<const add_inst*>(inst->component);
+        if (!inst_cream->S && inst_cream->Rd != 15 && next->idx == LDM_IDX) {
+            inst->idx = ADD_LDM_IDX;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
 MICROPROFILE_DEFINE(DynCom_Decode, "DynCom", "Decode", MP_RGB(255, 64, 64));
 
 static unsigned int InterpreterTranslateInstruction(const ARMul_State* cpu, const u32 phys_addr,
@@ -839,7 +894,7 @@ static unsigned int InterpreterTranslateInstruction(const ARMul_State* cpu, cons
     return inst_size;
 }
 
-static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, u32 addr) {
+static int InterpreterTranslateBlock(ARMul_State* cpu, u32& bb_start, u32 addr) {
     MICROPROFILE_SCOPE(DynCom_Decode);
 
     // Decode instruction, get index
@@ -848,12 +903,23 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, u3
     // Save start addr of basicblock in CreamCache
     ARM_INST_PTR inst_base = nullptr;
     TransExtData ret = TransExtData::NON_BRANCH;
-    bb_start = trans_cache_buf_top;
+    if (cpu->translation_cache.IsFull()) {
+        LOG_DEBUG(Core_ARM11, "Translation cache is full, clearing it");
+        cpu->translation_cache.Clear();
+    }
+    SetTranslationCache(&cpu->translation_cache);
+    cpu->translation_cache.BeginBlock();
 
     u32 phys_addr = addr;
     u32 pc_start = cpu->Reg[15];
 
+    // Superinstructions skip the breakpoint checks of their second instruction.
+    const bool fuse = !GDBStub::IsServerEnabled();
+    u32 inst_offset = 0;
+
     while (ret == TransExtData::NON_BRANCH) {
+        const u32 prev_offset = inst_offset;
+        inst_offset = cpu->translation_cache.Top() - cpu->translation_cache.BlockStart();
         u32 inst_size = InterpreterTranslateInstruction(cpu, phys_addr, inst_base);
         phys_addr += inst_size;
 
@@ -861,18 +927,30 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, u3
             inst_base->br = TransExtData::END_OF_PAGE;
         }
         ret = inst_base->br;
+
+        if (fuse && inst_offset != 0) {
+            // Translating the instruction may have moved the block into a new chunk.
+            const u32 block = cpu->translation_cache.BlockStart();
+            FuseInstructions(cpu, block + prev_offset, block + inst_offset);
+        }
     };
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    bb_start = cpu->translation_cache.BlockStart();
+    cpu->translation_cache.Insert(pc_start, bb_start);
 
     return KEEP_GOING;
 }
 
-static int InterpreterTranslateSingle(ARMul_State* cpu, std::size_t& bb_start, u32 addr) {
+static int InterpreterTranslateSingle(ARMul_State* cpu, u32& bb_start, u32 addr) {
     MICROPROFILE_SCOPE(DynCom_Decode);
 
     ARM_INST_PTR inst_base = nullptr;
-    bb_start = trans_cache_buf_top;
+    if (cpu->translation_cache.IsFull()) {
+        LOG_DEBUG(Core_ARM11, "Translation cache is full, clearing it");
+        cpu->translation_cache.Clear();
+    }
+    SetTranslationCache(&cpu->translation_cache);
+    cpu->translation_cache.BeginBlock();
 
     u32 phys_addr = addr;
     u32 pc_start = cpu->Reg[15];
@@ -883,7 +961,8 @@ static int InterpreterTranslateSingle(ARMul_State* cpu, std::size_t& bb_start, u
         inst_base->br = TransExtData::SINGLE_STEP;
     }
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    bb_start = cpu->translation_cache.BlockStart();
+    cpu->translation_cache.Insert(pc_start, bb_start);
 
     return KEEP_GOING;
 }
@@ -913,6 +992,76 @@ static int clz(unsigned int x) {
     return n;
 }
 
+/// Largest loop, in instructions including the closing branch, considered an idle loop candidate.
+static constexpr u32 IDLE_LOOP_MAX_INSTRUCTIONS = 8;
+
+/// Returns true if the ARM instruction has no effect besides writing registers and flags, which
+/// only leaves loads without writeback, data processing and hints not writing to the PC.
+static bool IsIdleLoopInstruction(u32 inst) {
+    if (BITS(inst, 28, 31) == 0xF) {
+        return false;
+    }
+    const u32 rd = BITS(inst, 12, 15);
+    switch (BITS(inst, 25, 27)) {
+    case 0b000:
+        if (BIT(inst, 4) && BIT(inst, 7)) {
+            // Multiplies and extra load/stores, of which only halfword and signed loads remain
+            return BITS(inst, 5, 6) != 0 && BIT(inst, 20) && BIT(inst, 24) && !BIT(inst, 21) &&
+                   rd != 15;
+        }
+        [[fallthrough]];
+    case 0b001:
+        if (BITS(inst, 23, 24) == 0b10) {
+            // Comparisons don't write Rd, the rest of this space are MRS/MSR/BX and hints
+            return BIT(inst, 20) || (inst & 0x0FFFFF00) == 0x0320F000;
+        }
+        return rd != 15;
+    case 0b010:
+    case 0b011:
+        if (BIT(inst, 25) && BIT(inst, 4)) {
+            return false;
+        }
+        return BIT(inst, 20) && BIT(inst, 24) && !BIT(inst, 21) && rd != 15;
+    default:
+        return false;
+    }
+}
+
+/**
+ * Checks whether the backward branch closes a loop that is idle, in three tiers of increasing
+ * cost. Only short ARM loops qualify, their body is analyzed once to contain nothing but loads
+ * and register operations, and the loop is only considered idle once an iteration left all
+ * registers and flags unchanged. Such an iteration repeats forever until another core or
+ * an event changes the memory it reads, so the rest of the slice can be skipped.
+ */
+static bool IsIdleLoop(ARMul_State* cpu, u32 head, u32 branch_pc) {
+    if (cpu->TFlag || head >= branch_pc ||
+        branch_pc - head >= IDLE_LOOP_MAX_INSTRUCTIONS * sizeof(u32) ||
+        !Settings::values.skip_idle_loops.GetValue() || GDBStub::IsServerEnabled()) {
+        return false;
+    }
+
+    // Direct branches always have the same target, so the analysis is keyed by the branch.
+    const auto [it, inserted] = cpu->idle_loop_cache.try_emplace(branch_pc, true);
+    if (inserted) {
+        for (u32 addr = head; addr < branch_pc && it->second; addr += sizeof(u32)) {
+            it->second = IsIdleLoopInstruction(cpu->memory.Read32(addr));
+        }
+    }
+    if (!it->second) {
+        return false;
+    }
+
+    const std::array<u32, 4> flags{cpu->NFlag, cpu->ZFlag, cpu->CFlag, cpu->VFlag};
+    const bool unchanged = cpu->idle_loop_branch == branch_pc && cpu->idle_loop_flags == flags &&
+                           std::equal(cpu->idle_loop_regs.begin(), cpu->idle_loop_regs.end(),
+                                      cpu->Reg.begin());
+    cpu->idle_loop_branch = branch_pc;
+    cpu->idle_loop_flags = flags;
+    std::copy_n(cpu->Reg.begin(), cpu->idle_loop_regs.size(), cpu->idle_loop_regs.begin());
+    return unchanged;
+}
+
 MICROPROFILE_DEFINE(DynCom_Execute, "DynCom", "Execute", MP_RGB(255, 0, 0));
 
 unsigned InterpreterMainLoop(ARMul_State* cpu) {
@@ -943,7 +1092,7 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
 #define FETCH_INST                                                                                 \
     if (inst_base->br != TransExtData::NON_BRANCH)                                                 \
         goto DISPATCH;                                                                             \
-    inst_base = (arm_inst*)&trans_cache_buf[ptr]
+    inst_base = (arm_inst*)ptr
 
 #define INC_PC(l) ptr += sizeof(arm_inst) + l
 #define INC_PC_STUB ptr += sizeof(arm_inst)
@@ -1391,6 +1540,14 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
         goto INIT_INST_LENGTH;                                                                     \
     case 204:                                                                                      \
         goto END;                                                                                  \
+    case 205:                                                                                      \
+        goto CMP_BBL_INST;                                                                         \
+    case 206:                                                                                      \
+        goto TST_BBL_INST;                                                                         \
+    case 207:                                                                                      \
+        goto LDR_CMP_INST;                                                                         \
+    case 208:                                                                                      \
+        goto ADD_LDM_INST;                                                                         \
     }
 #endif
 
@@ -1618,13 +1775,19 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
                          &&BLX_1_THUMB,
                          &&DISPATCH,
                          &&INIT_INST_LENGTH,
-                         &&END};
+                         &&END,
+                         &&CMP_BBL_INST,
+                         &&TST_BBL_INST,
+                         &&LDR_CMP_INST,
+                         &&ADD_LDM_INST};
+    static_assert(std::size(InstLabel) == ADD_LDM_IDX + 1);
 #endif
     arm_inst* inst_base;
     unsigned int addr;
     unsigned int num_instrs = 0;
 
-    std::size_t ptr;
+    u32 block;
+    char* ptr;
 
     LOAD_NZCVT;
 DISPATCH: {
@@ -1640,15 +1803,15 @@ DISPATCH: {
         cpu->Reg[15] &= 0xfffffffc;
 
     // Find the cached instruction cream, otherwise translate it...
-    auto itr = cpu->instruction_cache.find(cpu->Reg[15]);
-    if (itr != cpu->instruction_cache.end()) {
-        ptr = itr->second;
-    } else if (cpu->NumInstrsToExecute != 1) {
-        if (InterpreterTranslateBlock(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
-    } else {
-        if (InterpreterTranslateSingle(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
+    block = cpu->translation_cache.Find(cpu->Reg[15]);
+    if (block == TranslationCache::INVALID_BLOCK) {
+        if (cpu->NumInstrsToExecute != 1) {
+            if (InterpreterTranslateBlock(cpu, block, cpu->Reg[15]) == FETCH_EXCEPTION)
+                goto END;
+        } else {
+            if (InterpreterTranslateSingle(cpu, block, cpu->Reg[15]) == FETCH_EXCEPTION)
+                goto END;
+        }
     }
 
 #ifndef ANDROID
@@ -1659,7 +1822,8 @@ DISPATCH: {
     }
 #endif
 
-    inst_base = (arm_inst*)&trans_cache_buf[ptr];
+    ptr = cpu->translation_cache.Pointer(block);
+    inst_base = (arm_inst*)ptr;
     GOTO_NEXT_INST;
 }
 ADC_INST: {
@@ -1764,11 +1928,20 @@ AND_INST: {
 BBL_INST: {
     if ((inst_base->cond == ConditionCode::AL) || CondPassed(cpu, inst_base->cond)) {
         bbl_inst* inst_cream = (bbl_inst*)inst_base->component;
+        const u32 branch_pc = cpu->Reg[15];
         if (inst_cream->L) {
             LINK_RTN_ADDR;
         }
         SET_PC;
         INC_PC(sizeof(bbl_inst));
+        if (!inst_cream->L && IsIdleLoop(cpu, cpu->Reg[15], branch_pc)) {
+            LOG_TRACE(Core_ARM11, "Idle loop detected at {:08X}", branch_pc);
+            auto& timer = cpu->system.GetRunningCore().GetTimer();
+            timer.AddTicks(num_instrs);
+            timer.Idle();
+            num_instrs = 0;
+            goto END;
+        }
         goto DISPATCH;
     }
     cpu->Reg[15] += cpu->GetInstructionSize();
@@ -4539,9 +4712,18 @@ UXTB16_INST: {
 }
 
 WFE_INST: {
-    // Stubbed, as WFE is a hint instruction.
+    // Nothing happens until the next event, so skip the rest of the slice.
     if (inst_base->cond == ConditionCode::AL || CondPassed(cpu, inst_base->cond)) {
         LOG_TRACE(Core_ARM11, "WFE executed.");
+        if (Settings::values.skip_idle_loops.GetValue() && !GDBStub::IsServerEnabled()) {
+            auto& timer = cpu->system.GetRunningCore().GetTimer();
+            timer.AddTicks(num_instrs);
+            timer.Idle();
+            num_instrs = 0;
+            cpu->Reg[15] += cpu->GetInstructionSize();
+            INC_PC_STUB;
+            goto END;
+        }
     }
 
     cpu->Reg[15] += cpu->GetInstructionSize();
@@ -4551,9 +4733,18 @@ WFE_INST: {
 }
 
 WFI_INST: {
-    // Stubbed, as WFI is a hint instruction.
+    // Nothing happens until the next event, so skip the rest of the slice.
     if (inst_base->cond == ConditionCode::AL || CondPassed(cpu, inst_base->cond)) {
         LOG_TRACE(Core_ARM11, "WFI executed.");
+        if (Settings::values.skip_idle_loops.GetValue() && !GDBStub::IsServerEnabled()) {
+            auto& timer = cpu->system.GetRunningCore().GetTimer();
+            timer.AddTicks(num_instrs);
+            timer.Idle();
+            num_instrs = 0;
+            cpu->Reg[15] += cpu->GetInstructionSize();
+            INC_PC_STUB;
+            goto END;
+        }
     }
 
     cpu->Reg[15] += cpu->GetInstructionSize();
@@ -4574,6 +4765,78 @@ YIELD_INST: {
     GOTO_NEXT_INST;
 }
 
+// Continues a superinstruction with its second instruction, which is known at translation time.
+#define GOTO_FUSED_INST(label)                                                                     \
+    inst_base = (arm_inst*)ptr;                                                                    \
+    num_instrs++;                                                                                  \
+    goto label
+
+CMP_BBL_INST: {
+    cmp_inst* const inst_cream = (cmp_inst*)inst_base->component;
+
+    u32 rn_val = RN;
+    if (inst_cream->Rn == 15)
+        rn_val += 2 * cpu->GetInstructionSize();
+
+    bool carry;
+    bool overflow;
+    u32 result = AddWithCarry(rn_val, ~SHIFTER_OPERAND, 1, &carry, &overflow);
+
+    UPDATE_NFLAG(result);
+    UPDATE_ZFLAG(result);
+    cpu->CFlag = carry;
+    cpu->VFlag = overflow;
+
+    cpu->Reg[15] += cpu->GetInstructionSize();
+    INC_PC(sizeof(cmp_inst));
+    GOTO_FUSED_INST(BBL_INST);
+}
+
+TST_BBL_INST: {
+    tst_inst* const inst_cream = (tst_inst*)inst_base->component;
+
+    u32 lop = RN;
+    u32 rop = SHIFTER_OPERAND;
+
+    if (inst_cream->Rn == 15)
+        lop += cpu->GetInstructionSize() * 2;
+
+    u32 result = lop & rop;
+
+    UPDATE_NFLAG(result);
+    UPDATE_ZFLAG(result);
+    UPDATE_CFLAG_WITH_SC;
+
+    cpu->Reg[15] += cpu->GetInstructionSize();
+    INC_PC(sizeof(tst_inst));
+    GOTO_FUSED_INST(BBL_INST);
+}
+
+LDR_CMP_INST: {
+    ldst_inst* inst_cream = (ldst_inst*)inst_base->component;
+    inst_cream->get_addr(cpu, inst_cream->inst, addr);
+
+    cpu->Reg[BITS(inst_cream->inst, 12, 15)] = cpu->ReadMemory32(addr);
+
+    cpu->Reg[15] += cpu->GetInstructionSize();
+    INC_PC(sizeof(ldst_inst));
+    // The compare may have been fused with a following branch itself.
+    if (((arm_inst*)ptr)->idx == CMP_BBL_IDX) {
+        GOTO_FUSED_INST(CMP_BBL_INST);
+    }
+    GOTO_FUSED_INST(CMP_INST);
+}
+
+ADD_LDM_INST: {
+    add_inst* const inst_cream = (add_inst*)inst_base->component;
+
+    RD = CHECK_READ_REG15_WA(cpu, inst_cream->Rn) + SHIFTER_OPERAND;
+
+    cpu->Reg[15] += cpu->GetInstructionSize();
+    INC_PC(sizeof(add_inst));
+    GOTO_FUSED_INST(LDM_INST);
+}
+
 #define VFP_INTERPRETER_IMPL
 #include "core/arm/skyeye_common/vfp/vfpinstr.cpp"
 #undef VFP_INTERPRETER_IMPL
@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "core/arm/dyncom/arm_dyncom_trans.h"
@@ -6,14 +8,76 @@
 #include "core/arm/skyeye_common/armsupp.h"
 #include "core/arm/skyeye_common/vfp/vfp.h"
 
-char trans_cache_buf[TRANS_CACHE_SIZE];
-size_t trans_cache_buf_top = 0;
+TranslationCache::TranslationCache() : pages(1ULL << (32 - PAGE_BITS)) {}
+
+TranslationCache::~TranslationCache() = default;
+
+void TranslationCache::Insert(u32 addr, u32 handle) {
+    u32& leaf = pages[addr >> PAGE_BITS];
+    if (leaf == 0) {
+        leaves.emplace_back().fill(INVALID_BLOCK);
+        leaf = static_cast<u32>(leaves.size());
+    }
+    leaves[leaf - 1][(addr & PAGE_MASK) >> 1] = handle;
+}
+
+void TranslationCache::Invalidate(u32 addr, std::size_t size) {
+    if (size == 0) {
+        return;
+    }
+    // Blocks end at page boundaries, so the blocks overlapping the range start between the
+    // beginning of its first page and its end.
+    const u64 end = std::min<u64>(static_cast<u64>(addr) + size, 1ULL << 32);
+    for (u64 page = addr >> PAGE_BITS; page <= (end - 1) >> PAGE_BITS; page++) {
+        const u32 leaf = pages[page];
+        if (leaf == 0) {
+            continue;
+        }
+        const u64 page_end = std::min<u64>((page + 1) << PAGE_BITS, end);
+        const u32 count = static_cast<u32>(((page_end - 1) & PAGE_MASK) >> 1) + 1;
+        std::fill_n(leaves[leaf - 1].begin(), count, INVALID_BLOCK);
+    }
+}
+
+void TranslationCache::Clear() {
+    chunk_index = 0;
+    chunk_top = 0;
+    block_start = 0;
+    std::fill(pages.begin(), pages.end(), 0);
+    leaves.clear();
+}
+
+void* TranslationCache::Allocate(std::size_t size) {
+    if (chunks.empty()) {
+        chunks.emplace_back(new char[CHUNK_SIZE]);
+    }
+    if (chunk_top + size > CHUNK_SIZE) {
+        // The interpreter walks a block linearly, so the part of the block translated so far
+        // moves along into the next chunk. Completed blocks stay where they are.
+        const u32 block_size = Top() - block_start;
+        ASSERT(block_size + size <= CHUNK_SIZE);
+        const char* const block = chunks[chunk_index].get() + (chunk_top - block_size);
+        if (++chunk_index == chunks.size()) {
+            chunks.emplace_back(new char[CHUNK_SIZE]);
+        }
+        std::memcpy(chunks[chunk_index].get(), block, block_size);
+        chunk_top = block_size;
+        block_start = chunk_index << CHUNK_BITS;
+    }
+    void* const ptr = chunks[chunk_index].get() + chunk_top;
+    chunk_top += static_cast<u32>(size);
+    return ptr;
+}
+
+static thread_local TranslationCache* translation_cache = nullptr;
+
+void SetTranslationCache(TranslationCache* cache) {
+    translation_cache = cache;
+}
 
 static void* AllocBuffer(std::size_t size) {
-    std::size_t start = trans_cache_buf_top;
-    trans_cache_buf_top += size;
-    ASSERT_MSG(trans_cache_buf_top <= TRANS_CACHE_SIZE, "Translation cache is full!");
-    return static_cast<void*>(&trans_cache_buf[start]);
+    ASSERT(translation_cache != nullptr);
+    return translation_cache->Allocate(size);
 }
 
 #define glue(x, y) x##y
@@ -1807,7 +1871,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(yield)(unsigned int inst, int index) {
 #include "core/arm/skyeye_common/vfp/vfpinstr.cpp"
 #undef VFP_INTERPRETER_TRANS
 
-const transop_fp_t arm_instruction_trans[] = {
+constexpr transop_fp_t arm_instruction_trans[] = {
     INTERPRETER_TRANSLATE(vmla),
     INTERPRETER_TRANSLATE(vmls),
     INTERPRETER_TRANSLATE(vnmla),
@@ -2015,4 +2079,10 @@ const transop_fp_t arm_instruction_trans[] = {
     INTERPRETER_TRANSLATE(blx_1_thumb),
 };
 
-const std::size_t arm_instruction_trans_len = sizeof(arm_instruction_trans) / sizeof(transop_fp_t);
+static_assert(std::size(arm_instruction_trans) == arm_instruction_trans_len);
+static_assert(arm_instruction_trans[CMP_IDX] == INTERPRETER_TRANSLATE(cmp));
+static_assert(arm_instruction_trans[TST_IDX] == INTERPRETER_TRANSLATE(tst));
+static_assert(arm_instruction_trans[ADD_IDX] == INTERPRETER_TRANSLATE(add));
+static_assert(arm_instruction_trans[LDM_IDX] == INTERPRETER_TRANSLATE(ldm));
+static_assert(arm_instruction_trans[LDR_IDX] == INTERPRETER_TRANSLATE(ldr));
+static_assert(arm_instruction_trans[BBL_IDX] == INTERPRETER_TRANSLATE(bbl));
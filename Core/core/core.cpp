@@ -10,6 +10,7 @@
 #include "common/arch.h"
 #include "common/logging/log.h"
 #include "common/settings.h"
+#include "common/thread.h"
 #include "core/arm/arm_interface.h"
 #include "core/arm/exclusive_monitor.h"
 #include "core/hle/service/cam/cam.h"
@@ -242,27 +243,31 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
             kernel->GetThreadManager(cpu_core->GetID()).Reschedule();
             max_slice = std::min(max_slice, cpu_core->GetTimer().GetMaxSliceLength());
         }
-        for (auto& cpu_core : cpu_cores) {
-            cpu_core->GetTimer().SetNextSlice(max_slice);
-            auto start_ticks = cpu_core->GetTimer().GetTicks();
-            LOG_TRACE(Core_ARM11, "Core {} running for {} ticks", cpu_core->GetID(),
-                      cpu_core->GetTimer().GetDowncount());
-            running_core = cpu_core.get();
-            kernel->SetRunningCPU(running_core);
-            // If we don't have a currently active thread then don't execute instructions,
-            // instead advance to the next event and try to yield to the next thread
-            if (kernel->GetCurrentThreadManager().GetCurrentThread() == nullptr) {
-                LOG_TRACE(Core_ARM11, "Core {} idling", cpu_core->GetID());
-                cpu_core->GetTimer().Idle();
-                PrepareReschedule();
-            } else {
-                if (tight_loop) {
-                    cpu_core->Run();
+        if (parallel_cores && tight_loop && !GDBStub::IsServerEnabled()) {
+            RunParallelSlices(max_slice);
+        } else {
+            for (auto& cpu_core : cpu_cores) {
+                cpu_core->GetTimer().SetNextSlice(max_slice);
+                auto start_ticks = cpu_core->GetTimer().GetTicks();
+                LOG_TRACE(Core_ARM11, "Core {} running for {} ticks", cpu_core->GetID(),
+                          cpu_core->GetTimer().GetDowncount());
+                running_core = cpu_core.get();
+                kernel->SetRunningCPU(running_core);
+                // If we don't have a currently active thread then don't execute instructions,
+                // instead advance to the next event and try to yield to the next thread
+                if (kernel->GetCurrentThreadManager().GetCurrentThread() == nullptr) {
+                    LOG_TRACE(Core_ARM11, "Core {} idling", cpu_core->GetID());
+                    cpu_core->GetTimer().Idle();
+                    PrepareReschedule();
                 } else {
-                    cpu_core->Step();
+                    if (tight_loop) {
+                        cpu_core->Run();
+                    } else {
+                        cpu_core->Step();
+                    }
                 }
+                max_slice = cpu_core->GetTimer().GetTicks() - start_ticks;
             }
-            max_slice = cpu_core->GetTimer().GetTicks() - start_ticks;
         }
     }
 
@@ -275,6 +280,114 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
     return status;
 }
 
+std::unique_lock<std::mutex> System::LockCore(ARM_Interface& core) {
+    if (!parallel_cores) {
+        return {};
+    }
+    std::unique_lock lock{core_mutex};
+    if (running_core != &core) {
+        running_core = &core;
+        kernel->SwapRunningCPU(running_core);
+    }
+    return lock;
+}
+
+void System::RunCoreSlice(ARM_Interface& core) {
+    if (core.GetTimer().GetDowncount() <= 0) {
+        // The core is already ahead of the others and sits out this slice
+        return;
+    }
+    {
+        const auto lock = LockCore(core);
+        LOG_TRACE(Core_ARM11, "Core {} running for {} ticks", core.GetID(),
+                  core.GetTimer().GetDowncount());
+        // If we don't have a currently active thread then don't execute instructions,
+        // instead advance to the next event and try to yield to the next thread
+        if (kernel->GetCurrentThreadManager().GetCurrentThread() == nullptr) {
+            LOG_TRACE(Core_ARM11, "Core {} idling", core.GetID());
+            core.GetTimer().Idle();
+            PrepareReschedule();
+            return;
+        }
+    }
+    core.Run();
+}
+
+void System::CoreThread(std::stop_token stop_token, ARM_Interface& core) {
+    const std::string name = fmt::format("ARM11 Core {}", core.GetID());
+    Common::SetCurrentThreadName(name.c_str());
+    Common::SetCurrentThreadPriority(Common::ThreadPriority::High);
+
+    while (slice_barrier->Sync(stop_token)) {
+        RunCoreSlice(core);
+        if (!slice_barrier->Sync(stop_token)) {
+            break;
+        }
+    }
+}
+
+void System::RunParallelSlices(s64 max_slice) {
+    // Slices shorter than this are not worth another round of waking up the core threads
+    static constexpr s64 min_delay = 100;
+
+    for (auto& cpu_core : cpu_cores) {
+        cpu_core->GetTimer().SetNextSlice(max_slice);
+    }
+
+    while (true) {
+        // Run the slices of all cores at once, each on its own host thread. The first barrier
+        // releases the core threads and the second one waits for all of them to finish.
+        parallel_slice_running = true;
+        slice_barrier->Sync();
+        RunCoreSlice(*cpu_cores[0]);
+        slice_barrier->Sync();
+        parallel_slice_running = false;
+
+        for (const auto& [start_address, length] : pending_invalidations) {
+            for (const auto& cpu_core : cpu_cores) {
+                cpu_core->InvalidateCacheRange(start_address, length);
+            }
+        }
+        pending_invalidations.clear();
+
+        // A core stops early when it has to reschedule, e.g. after a SVC, and falls behind the
+        // others. Let the lagging cores catch up so all cores start the next slice at the same
+        // global time again.
+        for (auto& cpu_core : cpu_cores) {
+            running_core = cpu_core.get();
+            kernel->SetRunningCPU(running_core);
+            cpu_core->GetTimer().Advance();
+        }
+        const s64 global_ticks = timing->GetGlobalTicks();
+        bool lagging = false;
+        for (auto& cpu_core : cpu_cores) {
+            const s64 delay = global_ticks - cpu_core->GetTimer().GetTicks();
+            running_core = cpu_core.get();
+            kernel->SetRunningCPU(running_core);
+            cpu_core->PrepareReschedule();
+            kernel->GetThreadManager(cpu_core->GetID()).Reschedule();
+            cpu_core->GetTimer().SetNextSlice(delay > min_delay ? delay : 0);
+            lagging |= delay > min_delay;
+        }
+        if (!lagging) {
+            return;
+        }
+    }
+}
+
+void System::InvalidateCacheRange(u32 start_address, std::size_t length) {
+    if (parallel_slice_running) {
+        // The other cores are executing on their own host threads, so defer invalidating them
+        // until the slice ends. The caller holds the core lock.
+        running_core->InvalidateCacheRange(start_address, length);
+        pending_invalidations.emplace_back(start_address, length);
+        return;
+    }
+    for (const auto& cpu : cpu_cores) {
+        cpu->InvalidateCacheRange(start_address, length);
+    }
+}
+
 bool System::SendSignal(System::Signal signal, u32 param) {
     std::scoped_lock lock{signal_mutex};
     if (current_signal != signal && current_signal != Signal::None) {
@@ -469,6 +582,9 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window,
             cpu_cores.push_back(std::make_shared<ARM_Dynarmic>(
                 *this, *memory, i, timing->GetTimer(i), *exclusive_monitor));
         }
+        // Only the JIT accesses guest memory through the page table of its own core, which is
+        // required to run the cores at the same time.
+        parallel_cores = Settings::values.parallel_cpu_cores.GetValue() && num_cores > 1;
 #else
         for (u32 i = 0; i < num_cores; ++i) {
             cpu_cores.push_back(
@@ -487,6 +603,16 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window,
     kernel->SetCPUs(cpu_cores);
     kernel->SetRunningCPU(cpu_cores[0].get());
 
+    if (parallel_cores) {
+        LOG_INFO(Core, "Running {} CPU cores in parallel", num_cores);
+        slice_barrier = std::make_unique<Common::Barrier>(num_cores);
+        for (u32 i = 1; i < num_cores; ++i) {
+            core_threads.emplace_back([this, &core = *cpu_cores[i]](std::stop_token stop_token) {
+                CoreThread(stop_token, core);
+            });
+        }
+    }
+
     const auto audio_emulation = Settings::values.audio_emulation.GetValue();
     if (audio_emulation == Settings::AudioEmulation::HLE) {
         dsp_core = std::make_unique<AudioCore::DspHle>(*this);
@@ -647,6 +773,9 @@ void System::Shutdown(bool is_deserializing) {
     archive_manager.reset();
     service_manager.reset();
     dsp_core.reset();
+    core_threads.clear();
+    slice_barrier.reset();
+    parallel_cores = false;
     kernel.reset();
     cpu_cores.clear();
     exclusive_monitor.reset();
@@ -834,7 +963,7 @@ void System::serialize(Archive& ar, const unsigned int file_version) {
             if (thread) {
                 const std::shared_ptr<Kernel::Process> process = thread->owner_process.lock();
                 if (process) {
-                    gpu->Renderer().Rasterizer()->SwitchDiskResources(process->codeset->program_id);
+                    gpu->SwitchDiskResources(process->codeset->program_id);
                 }
             }
         }
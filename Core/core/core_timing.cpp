@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <bit>
 #include <random>
 #include <tuple>
 #include "common/assert.h"
@@ -55,6 +56,9 @@ TimingEventType* Timing::RegisterEvent(const std::string& name, TimedCallback ca
     auto info = event_types.emplace(name, TimingEventType{});
     TimingEventType* event_type = &info.first->second;
     event_type->name = &info.first->first;
+    if (info.second) {
+        event_type->id = static_cast<u32>(event_types.size() - 1);
+    }
     if (callback != nullptr) {
         event_type->callback = callback;
     }
@@ -83,8 +87,8 @@ void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_
         // of MAX_SLICE_LENGTH * 2 cycles into the future.
         cycles_into_future = std::max(static_cast<s64>(MAX_SLICE_LENGTH * 2), cycles_into_future);
 
-        timer->ts_queue.Push(Event{static_cast<s64>(timer->GetTicks() + cycles_into_future), 0,
-                                   user_data, event_type});
+        timer->PushThreadSafe(Event{static_cast<s64>(timer->GetTicks() + cycles_into_future), 0,
+                                    user_data, event_type});
     } else {
         s64 timeout = timer->GetTicks() + cycles_into_future;
         if (current_timer == timer) {
@@ -92,12 +96,10 @@ void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_
             if (!timer->is_timer_sane)
                 timer->ForceExceptionCheck(cycles_into_future);
 
-            timer->event_queue.emplace_back(
-                Event{timeout, timer->event_fifo_id++, user_data, event_type});
-            std::push_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
+            timer->event_queue.Push(Event{timeout, timer->event_fifo_id++, user_data, event_type});
         } else {
-            timer->ts_queue.Push(Event{static_cast<s64>(timer->GetTicks() + cycles_into_future), 0,
-                                       user_data, event_type});
+            timer->PushThreadSafe(Event{static_cast<s64>(timer->GetTicks() + cycles_into_future),
+                                        0, user_data, event_type});
         }
     }
 }
@@ -106,35 +108,18 @@ void Timing::UnscheduleEvent(const TimingEventType* event_type, std::uintptr_t u
     if (event_queue_locked) {
         return;
     }
-    for (auto timer : timers) {
-        auto itr = std::remove_if(
-            timer->event_queue.begin(), timer->event_queue.end(),
-            [&](const Event& e) { return e.type == event_type && e.user_data == user_data; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-        }
+    for (auto& timer : timers) {
+        timer->RemoveEvents(event_type, user_data);
     }
-    // TODO:remove events from ts_queue
 }
 
 void Timing::RemoveEvent(const TimingEventType* event_type) {
     if (event_queue_locked) {
         return;
     }
-    for (auto timer : timers) {
-        auto itr = std::remove_if(timer->event_queue.begin(), timer->event_queue.end(),
-                                  [&](const Event& e) { return e.type == event_type; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-        }
+    for (auto& timer : timers) {
+        timer->RemoveEvents(event_type, std::nullopt);
     }
-    // TODO:remove events from ts_queue
 }
 
 void Timing::SetCurrentTimer(std::size_t core_id) {
@@ -161,7 +146,218 @@ std::shared_ptr<Timing::Timer> Timing::GetTimer(std::size_t cpu_id) {
     return timers[cpu_id];
 }
 
-Timing::Timer::Timer(s64 base_ticks) : executed_ticks(base_ticks) {}
+Timing::EventWheel::EventWheel(s64 now_) {
+    Clear(now_);
+}
+
+const Timing::Event* Timing::EventWheel::Front() const {
+    if (!due.empty()) {
+        return &nodes[due.front()].event;
+    }
+    // Events of lower levels and lower slots always fire first, so the earliest event is in the
+    // first occupied slot of the lowest occupied level.
+    for (u32 level = 0; level < NUM_LEVELS; level++) {
+        if (occupied[level] == 0) {
+            continue;
+        }
+        const u32 bucket = level * NUM_SLOTS + std::countr_zero(occupied[level]);
+        u32 earliest = heads[bucket];
+        for (u32 node = nodes[earliest].next; node != INVALID_NODE; node = nodes[node].next) {
+            if (IsLater(earliest, node)) {
+                earliest = node;
+            }
+        }
+        return &nodes[earliest].event;
+    }
+    return nullptr;
+}
+
+void Timing::EventWheel::Push(const Event& event) {
+    u32 node = free_node;
+    if (node != INVALID_NODE) {
+        free_node = nodes[node].next;
+    } else {
+        node = static_cast<u32>(nodes.size());
+        nodes.emplace_back();
+    }
+    nodes[node].event = event;
+
+    const u32 type_id = event.type->id;
+    if (type_id >= type_heads.size()) {
+        type_heads.resize(type_id + 1, INVALID_NODE);
+    }
+    nodes[node].type_prev = INVALID_NODE;
+    nodes[node].type_next = type_heads[type_id];
+    if (type_heads[type_id] != INVALID_NODE) {
+        nodes[type_heads[type_id]].type_prev = node;
+    }
+    type_heads[type_id] = node;
+
+    Place(node);
+}
+
+void Timing::EventWheel::AdvanceTo(s64 now_) {
+    if (now_ <= now) {
+        return;
+    }
+    const u64 old_time = static_cast<u64>(now);
+    const u64 new_time = static_cast<u64>(now_);
+    now = now_;
+
+    // Collect the slots the current time moved over, these hold events that are either due or
+    // belong to a lower level now. When the bits above a level change, all of its slots are
+    // collected. Otherwise the levels above are unaffected.
+    for (u32 level = 0; level < NUM_LEVELS; level++) {
+        const u32 shift = GRANULARITY_BITS + level * SLOT_BITS;
+        const u32 upper_shift = shift + SLOT_BITS;
+        const bool wrapped =
+            upper_shift < 64 && (old_time >> upper_shift) != (new_time >> upper_shift);
+
+        u64 mask = ~0ULL;
+        if (!wrapped) {
+            const u32 first = (old_time >> shift) & (NUM_SLOTS - 1);
+            const u32 last = (new_time >> shift) & (NUM_SLOTS - 1);
+            mask = (~0ULL << first) & (~0ULL >> (NUM_SLOTS - 1 - last));
+        }
+        for (u64 pending = occupied[level] & mask; pending != 0; pending &= pending - 1) {
+            const u32 bucket = level * NUM_SLOTS + std::countr_zero(pending);
+            for (u32 node = heads[bucket]; node != INVALID_NODE; node = nodes[node].next) {
+                cascade.push_back(node);
+            }
+            heads[bucket] = INVALID_NODE;
+        }
+        occupied[level] &= ~mask;
+
+        if (!wrapped) {
+            break;
+        }
+    }
+
+    for (const u32 node : cascade) {
+        Place(node);
+    }
+    cascade.clear();
+}
+
+bool Timing::EventWheel::PopDue(Event& event) {
+    if (due.empty()) {
+        return false;
+    }
+    const auto is_later = [this](u32 lhs, u32 rhs) { return IsLater(lhs, rhs); };
+    std::pop_heap(due.begin(), due.end(), is_later);
+    const u32 node = due.back();
+    due.pop_back();
+
+    event = nodes[node].event;
+    Release(node);
+    return true;
+}
+
+void Timing::EventWheel::Erase(const TimingEventType* event_type,
+                               std::optional<std::uintptr_t> user_data) {
+    if (event_type->id >= type_heads.size()) {
+        return;
+    }
+    u32 node = type_heads[event_type->id];
+    while (node != INVALID_NODE) {
+        const u32 next = nodes[node].type_next;
+        if (!user_data || nodes[node].event.user_data == *user_data) {
+            Unlink(node);
+            Release(node);
+        }
+        node = next;
+    }
+}
+
+std::vector<Timing::Event> Timing::EventWheel::Events() const {
+    std::vector<Event> events;
+    for (const Node& node : nodes) {
+        if (node.bucket != FREE_BUCKET) {
+            events.push_back(node.event);
+        }
+    }
+    std::sort(events.begin(), events.end());
+    return events;
+}
+
+void Timing::EventWheel::Clear(s64 now_) {
+    nodes.clear();
+    due.clear();
+    type_heads.clear();
+    heads.fill(INVALID_NODE);
+    occupied.fill(0);
+    free_node = INVALID_NODE;
+    now = now_;
+}
+
+void Timing::EventWheel::Place(u32 node) {
+    Node& entry = nodes[node];
+    if (entry.event.time <= now) {
+        entry.bucket = DUE_BUCKET;
+        due.push_back(node);
+        std::push_heap(due.begin(), due.end(),
+                       [this](u32 lhs, u32 rhs) { return IsLater(lhs, rhs); });
+        return;
+    }
+
+    const u64 time = static_cast<u64>(entry.event.time);
+    const u32 highest_bit = std::bit_width(time ^ static_cast<u64>(now)) - 1;
+    const u32 level = highest_bit < GRANULARITY_BITS + SLOT_BITS
+                          ? 0
+                          : (highest_bit - GRANULARITY_BITS) / SLOT_BITS;
+    const u32 slot = (time >> (GRANULARITY_BITS + level * SLOT_BITS)) & (NUM_SLOTS - 1);
+    const u32 bucket = level * NUM_SLOTS + slot;
+
+    entry.bucket = bucket;
+    entry.prev = INVALID_NODE;
+    entry.next = heads[bucket];
+    if (heads[bucket] != INVALID_NODE) {
+        nodes[heads[bucket]].prev = node;
+    }
+    heads[bucket] = node;
+    occupied[level] |= 1ULL << slot;
+}
+
+void Timing::EventWheel::Unlink(u32 node) {
+    Node& entry = nodes[node];
+    if (entry.bucket == DUE_BUCKET) {
+        // Events are only due while the timer advances, so the heap is tiny.
+        due.erase(std::find(due.begin(), due.end(), node));
+        std::make_heap(due.begin(), due.end(),
+                       [this](u32 lhs, u32 rhs) { return IsLater(lhs, rhs); });
+        return;
+    }
+
+    if (entry.prev != INVALID_NODE) {
+        nodes[entry.prev].next = entry.next;
+    } else {
+        heads[entry.bucket] = entry.next;
+        if (entry.next == INVALID_NODE) {
+            occupied[entry.bucket / NUM_SLOTS] &= ~(1ULL << (entry.bucket % NUM_SLOTS));
+        }
+    }
+    if (entry.next != INVALID_NODE) {
+        nodes[entry.next].prev = entry.prev;
+    }
+}
+
+void Timing::EventWheel::Release(u32 node) {
+    Node& entry = nodes[node];
+    if (entry.type_prev != INVALID_NODE) {
+        nodes[entry.type_prev].type_next = entry.type_next;
+    } else {
+        type_heads[entry.event.type->id] = entry.type_next;
+    }
+    if (entry.type_next != INVALID_NODE) {
+        nodes[entry.type_next].type_prev = entry.type_prev;
+    }
+
+    entry.bucket = FREE_BUCKET;
+    entry.next = free_node;
+    free_node = node;
+}
+
+Timing::Timer::Timer(s64 base_ticks) : event_queue(base_ticks), executed_ticks(base_ticks) {}
 
 Timing::Timer::~Timer() {
     MoveEvents();
@@ -192,16 +388,31 @@ void Timing::Timer::ForceExceptionCheck(s64 cycles) {
 }
 
 void Timing::Timer::MoveEvents() {
-    for (Event ev; ts_queue.Pop(ev);) {
+    std::scoped_lock lock{ts_mutex};
+    for (Event& ev : ts_queue) {
         ev.fifo_order = event_fifo_id++;
-        event_queue.emplace_back(std::move(ev));
-        std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+        event_queue.Push(ev);
     }
+    ts_queue.clear();
+}
+
+void Timing::Timer::PushThreadSafe(const Event& event) {
+    std::scoped_lock lock{ts_mutex};
+    ts_queue.push_back(event);
+}
+
+void Timing::Timer::RemoveEvents(const TimingEventType* event_type,
+                                 std::optional<std::uintptr_t> user_data) {
+    event_queue.Erase(event_type, user_data);
+
+    std::scoped_lock lock{ts_mutex};
+    std::erase_if(ts_queue, [&](const Event& e) {
+        return e.type == event_type && (!user_data || e.user_data == *user_data);
+    });
 }
 
 s64 Timing::Timer::GetMaxSliceLength() const {
-    const auto& next_event = event_queue.begin();
-    if (next_event != event_queue.end()) {
+    if (const Event* next_event = event_queue.Front()) {
         ASSERT(next_event->time - executed_ticks > 0);
         return next_event->time - executed_ticks;
     }
@@ -219,10 +430,8 @@ void Timing::Timer::Advance() {
 
     is_timer_sane = true;
 
-    while (!event_queue.empty() && event_queue.front().time <= executed_ticks) {
-        Event evt = std::move(event_queue.front());
-        std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-        event_queue.pop_back();
+    event_queue.AdvanceTo(executed_ticks);
+    for (Event evt; event_queue.PopDue(evt);) {
         if (evt.type->callback != nullptr) {
             evt.type->callback(evt.user_data, static_cast<int>(executed_ticks - evt.time));
         } else {
@@ -237,9 +446,9 @@ void Timing::Timer::SetNextSlice(s64 max_slice_length) {
     slice_length = max_slice_length;
 
     // Still events left (scheduled in the future)
-    if (!event_queue.empty()) {
+    if (const Event* next_event = event_queue.Front()) {
         slice_length = static_cast<int>(
-            std::min<s64>(event_queue.front().time - executed_ticks, max_slice_length));
+            std::min<s64>(next_event->time - executed_ticks, max_slice_length));
     }
 
     downcount = slice_length;
@@ -613,7 +613,7 @@ Result GSP_GPU::AcquireGpuRight(const Kernel::HLERequestContext& ctx,
                 ErrorLevel::Success};
     }
 
-    gpu.Renderer().Rasterizer()->SwitchDiskResources(process->codeset->program_id);
+    gpu.SwitchDiskResources(process->codeset->program_id);
 
     if (blocking) {
         // TODO: The thread should be put to sleep until acquired.
@@ -5,7 +5,9 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstring>
 #include <memory>
+#include "common/arch.h"
 #include "common/assert.h"
 #include "common/color.h"
 #include "common/common_types.h"
@@ -16,6 +18,12 @@
 #include "core/hw/y2r.h"
 #include "core/memory.h"
 
+#if CITRA_ARCH(x86_64)
+#include <emmintrin.h>
+#elif CITRA_ARCH(arm64)
+#include <arm_neon.h>
+#endif
+
 namespace HW::Y2R {
 
 using namespace Service::Y2R;
@@ -24,55 +32,169 @@ static const std::size_t MAX_TILES = 1024 / 8;
 static const std::size_t TILE_SIZE = 8 * 8;
 using ImageTile = std::array<u32, TILE_SIZE>;
 
-/// Converts a image strip from the source YUV format into individual 8x8 RGB32 tiles.
+/// Number of pixels converted at once. Input line widths are always a multiple of it.
+static constexpr std::size_t GROUP_SIZE = 8;
+
+// This conversion process is bit-exact with hardware, as far as could be tested. Every pair of
+// horizontally adjacent pixels shares its U and V samples, so a group holds 8 Y and 4 U/V values.
+// The RGB32 result stores red, green and blue in the upper three bytes of each pixel.
+
+#if CITRA_ARCH(x86_64)
+
+/// Returns pairs of 16-bit coefficients to multiply interleaved 16-bit values with.
+static __m128i CoefficientPair(s16 first, s16 second) {
+    return _mm_set1_epi32(static_cast<u16>(first) | (static_cast<u32>(second) << 16));
+}
+
+static __m128i FinishChannel(__m128i value, __m128i offset) {
+    return _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(value, 3), offset), 5);
+}
+
+static void ConvertGroup(const u8* Y, const u8* U, const u8* V, u32* output,
+                         const CoefficientSet& c) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i y = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(Y)), zero);
+    const auto load_chroma = [&](const u8* source) {
+        u32 samples;
+        std::memcpy(&samples, source, sizeof(samples));
+        const __m128i value = _mm_cvtsi32_si128(static_cast<int>(samples));
+        return _mm_unpacklo_epi8(_mm_unpacklo_epi8(value, value), zero);
+    };
+    const __m128i u = load_chroma(U);
+    const __m128i v = load_chroma(V);
+
+    const __m128i y_only = CoefficientPair(c[0], 0);
+    const __m128i y_v = CoefficientPair(c[0], c[1]);
+    const __m128i v_u = CoefficientPair(c[2], c[3]);
+    const __m128i y_u = CoefficientPair(c[0], c[4]);
+    const __m128i r_offset = _mm_set1_epi32(c[5] + 0x18);
+    const __m128i g_offset = _mm_set1_epi32(c[6] + 0x18);
+    const __m128i b_offset = _mm_set1_epi32(c[7] + 0x18);
+
+    __m128i r[2], g[2], b[2];
+    for (std::size_t half = 0; half < 2; half++) {
+        const auto interleave = [half](__m128i first, __m128i second) {
+            return half == 0 ? _mm_unpacklo_epi16(first, second)
+                             : _mm_unpackhi_epi16(first, second);
+        };
+        const __m128i cY = _mm_madd_epi16(interleave(y, zero), y_only);
+        r[half] = FinishChannel(_mm_madd_epi16(interleave(y, v), y_v), r_offset);
+        g[half] = FinishChannel(_mm_sub_epi32(cY, _mm_madd_epi16(interleave(v, u), v_u)),
+                                g_offset);
+        b[half] = FinishChannel(_mm_madd_epi16(interleave(y, u), y_u), b_offset);
+    }
+
+    // Saturating packs clamp every channel to [0, 255].
+    const auto pack = [](const __m128i* channel) {
+        const __m128i packed = _mm_packs_epi32(channel[0], channel[1]);
+        return _mm_packus_epi16(packed, packed);
+    };
+    const __m128i zero_b = _mm_unpacklo_epi8(zero, pack(b));
+    const __m128i g_r = _mm_unpacklo_epi8(pack(g), pack(r));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_unpacklo_epi16(zero_b, g_r));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 4), _mm_unpackhi_epi16(zero_b, g_r));
+}
+
+#elif CITRA_ARCH(arm64)
+
+static void ConvertGroup(const u8* Y, const u8* U, const u8* V, u32* output,
+                         const CoefficientSet& c) {
+    const int16x8_t y = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(Y)));
+    const auto load_chroma = [](const u8* source) {
+        u32 samples;
+        std::memcpy(&samples, source, sizeof(samples));
+        const uint8x8_t value = vreinterpret_u8_u32(vdup_n_u32(samples));
+        return vreinterpretq_s16_u16(vmovl_u8(vzip_u8(value, value).val[0]));
+    };
+    const int16x8_t u = load_chroma(U);
+    const int16x8_t v = load_chroma(V);
+
+    const auto finish = [](int32x4_t value, s32 offset) {
+        return vshrq_n_s32(vaddq_s32(vshrq_n_s32(value, 3), vdupq_n_s32(offset)), 5);
+    };
+    const auto convert = [&](int16x4_t y_half, int16x4_t u_half, int16x4_t v_half,
+                             int32x4_t& r, int32x4_t& g, int32x4_t& b) {
+        const int32x4_t cY = vmull_n_s16(y_half, c[0]);
+        r = finish(vmlal_n_s16(cY, v_half, c[1]), c[5] + 0x18);
+        g = finish(vmlsl_n_s16(vmlsl_n_s16(cY, v_half, c[2]), u_half, c[3]), c[6] + 0x18);
+        b = finish(vmlal_n_s16(cY, u_half, c[4]), c[7] + 0x18);
+    };
+    int32x4_t r_lo, g_lo, b_lo, r_hi, g_hi, b_hi;
+    convert(vget_low_s16(y), vget_low_s16(u), vget_low_s16(v), r_lo, g_lo, b_lo);
+    convert(vget_high_s16(y), vget_high_s16(u), vget_high_s16(v), r_hi, g_hi, b_hi);
+
+    // Saturating narrows clamp every channel to [0, 255].
+    const auto pack = [](int32x4_t lo, int32x4_t hi) {
+        return vqmovun_s16(vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+    };
+    const uint8x8x4_t pixels = {vdup_n_u8(0), pack(b_lo, b_hi), pack(g_lo, g_hi),
+                                pack(r_lo, r_hi)};
+    vst4_u8(reinterpret_cast<u8*>(output), pixels);
+}
+
+#else
+
+static void ConvertGroup(const u8* Y, const u8* U, const u8* V, u32* output,
+                         const CoefficientSet& c) {
+    for (std::size_t x = 0; x < GROUP_SIZE; ++x) {
+        const s32 cY = c[0] * Y[x];
+        const s32 u = U[x / 2];
+        const s32 v = V[x / 2];
+
+        s32 r = cY + c[1] * v;
+        s32 g = cY - c[2] * v - c[3] * u;
+        s32 b = cY + c[4] * u;
+
+        const s32 rounding_offset = 0x18;
+        r = (r >> 3) + c[5] + rounding_offset;
+        g = (g >> 3) + c[6] + rounding_offset;
+        b = (b >> 3) + c[7] + rounding_offset;
+
+        output[x] = ((u32)std::clamp(r >> 5, 0, 0xFF) << 24) |
+                    ((u32)std::clamp(g >> 5, 0, 0xFF) << 16) |
+                    ((u32)std::clamp(b >> 5, 0, 0xFF) << 8);
+    }
+}
+
+#endif
+
+/**
+ * Converts an image strip from the source YUV format to RGB32. The pixel at (x, y) is stored at
+ * output[(x / 8) * tile_stride + y * row_stride + x % 8], which allows producing either individual
+ * 8x8 tiles or plain rows.
+ */
 template <InputFormat input_format>
-static void ConvertYUVToRGB(const u8* input_Y, const u8* input_U, const u8* input_V,
-                            ImageTile output[], unsigned int width, unsigned int height,
-                            const CoefficientSet& coefficients) {
+static void ConvertYUVToRGB(const u8* input_Y, const u8* input_U, const u8* input_V, u32* output,
+                            std::size_t tile_stride, std::size_t row_stride, unsigned int width,
+                            unsigned int height, const CoefficientSet& coefficients) {
+    std::array<u8, GROUP_SIZE> group_Y;
+    std::array<u8, GROUP_SIZE / 2> group_U;
+    std::array<u8, GROUP_SIZE / 2> group_V;
 
     for (unsigned int y = 0; y < height; ++y) {
-        for (unsigned int x = 0; x < width; ++x) {
-            s32 Y;
-            s32 U;
-            s32 V;
+        for (unsigned int x = 0; x < width; x += GROUP_SIZE) {
+            u32* const out = output + (x / GROUP_SIZE) * tile_stride + y * row_stride;
             if constexpr (input_format == InputFormat::YUV422_Indiv8 ||
                           input_format == InputFormat::YUV422_Indiv16) {
-                Y = input_Y[y * width + x];
-                U = input_U[(y * width + x) / 2];
-                V = input_V[(y * width + x) / 2];
+                ConvertGroup(input_Y + y * width + x, input_U + (y * width + x) / 2,
+                             input_V + (y * width + x) / 2, out, coefficients);
             } else if constexpr (input_format == InputFormat::YUV420_Indiv8 ||
                                  input_format == InputFormat::YUV420_Indiv16) {
-                Y = input_Y[y * width + x];
-                U = input_U[((y / 2) * width + x) / 2];
-                V = input_V[((y / 2) * width + x) / 2];
+                ConvertGroup(input_Y + y * width + x, input_U + ((y / 2) * width + x) / 2,
+                             input_V + ((y / 2) * width + x) / 2, out, coefficients);
             } else if constexpr (input_format == InputFormat::YUYV422_Interleaved) {
-                Y = input_Y[(y * width + x) * 2];
-                U = input_Y[(y * width + (x / 2) * 2) * 2 + 1];
-                V = input_Y[(y * width + (x / 2) * 2) * 2 + 3];
+                const u8* const yuyv = input_Y + (y * width + x) * 2;
+                for (std::size_t i = 0; i < GROUP_SIZE / 2; ++i) {
+                    group_Y[i * 2] = yuyv[i * 4];
+                    group_U[i] = yuyv[i * 4 + 1];
+                    group_Y[i * 2 + 1] = yuyv[i * 4 + 2];
+                    group_V[i] = yuyv[i * 4 + 3];
+                }
+                ConvertGroup(group_Y.data(), group_U.data(), group_V.data(), out, coefficients);
             } else {
                 UNREACHABLE_MSG("Unknown Y2R input format {}", input_format);
                 return;
             }
-
-            // This conversion process is bit-exact with hardware, as far as could be tested.
-            auto& c = coefficients;
-            s32 cY = c[0] * Y;
-
-            s32 r = cY + c[1] * V;
-            s32 g = cY - c[2] * V - c[3] * U;
-            s32 b = cY + c[4] * U;
-
-            const s32 rounding_offset = 0x18;
-            r = (r >> 3) + c[5] + rounding_offset;
-            g = (g >> 3) + c[6] + rounding_offset;
-            b = (b >> 3) + c[7] + rounding_offset;
-
-            unsigned int tile = x / 8;
-            unsigned int tile_x = x % 8;
-            u32* out = &output[tile][y * 8 + tile_x];
-            *out = ((u32)std::clamp(r >> 5, 0, 0xFF) << 24) |
-                   ((u32)std::clamp(g >> 5, 0, 0xFF) << 16) |
-                   ((u32)std::clamp(b >> 5, 0, 0xFF) << 8);
         }
     }
 }
@@ -101,40 +223,51 @@ static void ReceiveData(Memory::MemorySystem& memory, u8* output, ConversionBuff
     }
 }
 
+/// Converts a run of intermediate RGB32 pixels to the final output format.
+template <OutputFormat output_format>
+static void EncodeRGB(const u32* input, u8* output, std::size_t count, u8 alpha) {
+    for (std::size_t i = 0; i < count; ++i) {
+        const u32 color = input[i];
+        if constexpr (output_format == OutputFormat::RGBA8) {
+            const u32 value = color | alpha;
+            std::memcpy(output + i * 4, &value, sizeof(value));
+        } else if constexpr (output_format == OutputFormat::RGB8) {
+            output[i * 3] = static_cast<u8>(color >> 8);
+            output[i * 3 + 1] = static_cast<u8>(color >> 16);
+            output[i * 3 + 2] = static_cast<u8>(color >> 24);
+        } else if constexpr (output_format == OutputFormat::RGB5A1) {
+            const u16 value = ((color >> 16) & 0xF800) | ((color >> 13) & 0x07C0) |
+                              ((color >> 10) & 0x003E) | (alpha >> 7);
+            std::memcpy(output + i * 2, &value, sizeof(value));
+        } else if constexpr (output_format == OutputFormat::RGB565) {
+            const u16 value =
+                ((color >> 16) & 0xF800) | ((color >> 13) & 0x07E0) | ((color >> 11) & 0x001F);
+            std::memcpy(output + i * 2, &value, sizeof(value));
+        } else {
+            UNREACHABLE_MSG("Unknown Y2R output format {}", output_format);
+        }
+    }
+}
+
 /// Convert intermediate RGB32 format to the final output format while simulating an outgoing CDMA
 /// transfer.
 template <OutputFormat output_format>
 static void SendData(Memory::MemorySystem& memory, const u32* input, ConversionBuffer& buf,
                      int amount_of_data, u8 alpha) {
+    constexpr std::size_t bytes_per_pixel = output_format == OutputFormat::RGBA8  ? 4
+                                            : output_format == OutputFormat::RGB8 ? 3
+                                                                                  : 2;
+    // Each transfer unit receives whole pixels, the last of which may spill into the gap.
+    const std::size_t unit_pixels = (buf.transfer_unit + bytes_per_pixel - 1) / bytes_per_pixel;
 
     u8* output = memory.GetPointer(buf.address);
 
     while (amount_of_data > 0) {
-        u8* unit_end = output + buf.transfer_unit;
-        while (output < unit_end) {
-            u32 color = *input++;
-            Common::Vec4<u8> col_vec{(u8)(color >> 24), (u8)(color >> 16), (u8)(color >> 8), alpha};
-
-            if constexpr (output_format == OutputFormat::RGBA8) {
-                Common::Color::EncodeRGBA8(col_vec, output);
-                output += 4;
-            } else if constexpr (output_format == OutputFormat::RGB8) {
-                Common::Color::EncodeRGB8(col_vec, output);
-                output += 3;
-            } else if constexpr (output_format == OutputFormat::RGB5A1) {
-                Common::Color::EncodeRGB5A1(col_vec, output);
-                output += 2;
-            } else if constexpr (output_format == OutputFormat::RGB565) {
-                Common::Color::EncodeRGB565(col_vec, output);
-                output += 2;
-            } else {
-                UNREACHABLE_MSG("Unknown Y2R output format {}", output_format);
-            }
-
-            amount_of_data -= 1;
-        }
+        EncodeRGB<output_format>(input, output, unit_pixels, alpha);
+        input += unit_pixels;
+        amount_of_data -= static_cast<int>(unit_pixels);
 
-        output += buf.gap;
+        output += unit_pixels * bytes_per_pixel + buf.gap;
         buf.address += buf.transfer_unit + buf.gap;
         buf.image_size -= buf.transfer_unit;
     }
@@ -276,6 +409,21 @@ void PerformConversion(Memory::MemorySystem& memory, ConversionConfiguration cvt
     std::unique_ptr<ImageTile[]> tiles(new ImageTile[num_tiles]);
     ImageTile tmp_tile;
 
+    // Without rotation the rows of linear output are the rows of the strip, so the conversion
+    // writes them directly instead of going through the tiles. The strip is read from the CDMA
+    // buffer at the same time, so the output goes to a separate buffer.
+    const bool direct_output =
+        cvt.rotation == Rotation::None && cvt.block_alignment == BlockAlignment::Linear;
+    std::unique_ptr<u32[]> direct_buffer;
+    if (direct_output) {
+        direct_buffer.reset(new u32[cvt.input_line_width * 8]);
+    }
+    u32* const output_pixels =
+        direct_output ? direct_buffer.get() : reinterpret_cast<u32*>(data_buffer.get());
+    u32* const convert_output = direct_output ? output_pixels : tiles[0].data();
+    const std::size_t tile_stride = direct_output ? GROUP_SIZE : TILE_SIZE;
+    const std::size_t row_stride = direct_output ? cvt.input_line_width : GROUP_SIZE;
+
     // LUT used to remap writes to a tile. Used to allow linear or swizzled output without
     // requiring two different code paths.
     const u8* tile_remap = nullptr;
@@ -303,109 +451,111 @@ void PerformConversion(Memory::MemorySystem& memory, ConversionConfiguration cvt
             ReceiveData<1>(memory, input_Y, cvt.src_Y, row_data_size);
             ReceiveData<1>(memory, input_U, cvt.src_U, row_data_size / 2);
             ReceiveData<1>(memory, input_V, cvt.src_V, row_data_size / 2);
-            ConvertYUVToRGB<InputFormat::YUV422_Indiv8>(input_Y, input_U, input_V, tiles.get(),
-                                                        cvt.input_line_width, row_height,
-                                                        cvt.coefficients);
+            ConvertYUVToRGB<InputFormat::YUV422_Indiv8>(
+                input_Y, input_U, input_V, convert_output, tile_stride, row_stride,
+                cvt.input_line_width, row_height, cvt.coefficients);
             break;
         case InputFormat::YUV420_Indiv8:
             ReceiveData<1>(memory, input_Y, cvt.src_Y, row_data_size);
             ReceiveData<1>(memory, input_U, cvt.src_U, row_data_size / 4);
             ReceiveData<1>(memory, input_V, cvt.src_V, row_data_size / 4);
-            ConvertYUVToRGB<InputFormat::YUV420_Indiv8>(input_Y, input_U, input_V, tiles.get(),
-                                                        cvt.input_line_width, row_height,
-                                                        cvt.coefficients);
+            ConvertYUVToRGB<InputFormat::YUV420_Indiv8>(
+                input_Y, input_U, input_V, convert_output, tile_stride, row_stride,
+                cvt.input_line_width, row_height, cvt.coefficients);
             break;
         case InputFormat::YUV422_Indiv16:
             ReceiveData<2>(memory, input_Y, cvt.src_Y, row_data_size);
             ReceiveData<2>(memory, input_U, cvt.src_U, row_data_size / 2);
             ReceiveData<2>(memory, input_V, cvt.src_V, row_data_size / 2);
-            ConvertYUVToRGB<InputFormat::YUV422_Indiv16>(input_Y, input_U, input_V, tiles.get(),
-                                                         cvt.input_line_width, row_height,
-                                                         cvt.coefficients);
+            ConvertYUVToRGB<InputFormat::YUV422_Indiv16>(
+                input_Y, input_U, input_V, convert_output, tile_stride, row_stride,
+                cvt.input_line_width, row_height, cvt.coefficients);
             break;
         case InputFormat::YUV420_Indiv16:
             ReceiveData<2>(memory, input_Y, cvt.src_Y, row_data_size);
             ReceiveData<2>(memory, input_U, cvt.src_U, row_data_size / 4);
             ReceiveData<2>(memory, input_V, cvt.src_V, row_data_size / 4);
-            ConvertYUVToRGB<InputFormat::YUV420_Indiv16>(input_Y, input_U, input_V, tiles.get(),
-                                                         cvt.input_line_width, row_height,
-                                                         cvt.coefficients);
+            ConvertYUVToRGB<InputFormat::YUV420_Indiv16>(
+                input_Y, input_U, input_V, convert_output, tile_stride, row_stride,
+                cvt.input_line_width, row_height, cvt.coefficients);
             break;
         case InputFormat::YUYV422_Interleaved:
             input_U = nullptr;
             input_V = nullptr;
             ReceiveData<1>(memory, input_Y, cvt.src_YUYV, row_data_size * 2);
-            ConvertYUVToRGB<InputFormat::YUYV422_Interleaved>(input_Y, input_U, input_V,
-                                                              tiles.get(), cvt.input_line_width,
-                                                              row_height, cvt.coefficients);
+            ConvertYUVToRGB<InputFormat::YUYV422_Interleaved>(
+                input_Y, input_U, input_V, convert_output, tile_stride, row_stride,
+                cvt.input_line_width, row_height, cvt.coefficients);
             break;
         default:
             UNREACHABLE_MSG("Unknown Y2R input format {}", cvt.input_format);
             return;
         }
 
-        u32* output_buffer = reinterpret_cast<u32*>(data_buffer.get());
-
-        for (std::size_t i = 0; i < num_tiles; ++i) {
-            int image_strip_width = 0;
-            int output_stride = 0;
-
-            switch (cvt.rotation) {
-            case Rotation::None:
-                RotateTile0(tiles[i], tmp_tile, row_height, tile_remap);
-                image_strip_width = cvt.input_line_width;
-                output_stride = 8;
-                break;
-            case Rotation::Clockwise_90:
-                RotateTile90(tiles[i], tmp_tile, row_height, tile_remap);
-                image_strip_width = 8;
-                output_stride = 8 * row_height;
-                break;
-            case Rotation::Clockwise_180:
-                // For 180 and 270 degree rotations we also invert the order of tiles in the strip,
-                // since the rotates are done individually on each tile.
-                RotateTile180(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
-                image_strip_width = cvt.input_line_width;
-                output_stride = 8;
-                break;
-            case Rotation::Clockwise_270:
-                RotateTile270(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
-                image_strip_width = 8;
-                output_stride = 8 * row_height;
-                break;
-            }
-
-            switch (cvt.block_alignment) {
-            case BlockAlignment::Linear:
-                WriteTileToOutput(output_buffer, tmp_tile, row_height, image_strip_width);
-                output_buffer += output_stride;
-                break;
-            case BlockAlignment::Block8x8:
-                WriteTileToOutput(output_buffer, tmp_tile, 8, 8);
-                output_buffer += TILE_SIZE;
-                break;
+        u32* output_buffer = output_pixels;
+
+        if (!direct_output) {
+            for (std::size_t i = 0; i < num_tiles; ++i) {
+                int image_strip_width = 0;
+                int output_stride = 0;
+
+                switch (cvt.rotation) {
+                case Rotation::None:
+                    RotateTile0(tiles[i], tmp_tile, row_height, tile_remap);
+                    image_strip_width = cvt.input_line_width;
+                    output_stride = 8;
+                    break;
+                case Rotation::Clockwise_90:
+                    RotateTile90(tiles[i], tmp_tile, row_height, tile_remap);
+                    image_strip_width = 8;
+                    output_stride = 8 * row_height;
+                    break;
+                case Rotation::Clockwise_180:
+                    // For 180 and 270 degree rotations we also invert the order of tiles in the
+                    // strip, since the rotates are done individually on each tile.
+                    RotateTile180(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
+                    image_strip_width = cvt.input_line_width;
+                    output_stride = 8;
+                    break;
+                case Rotation::Clockwise_270:
+                    RotateTile270(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
+                    image_strip_width = 8;
+                    output_stride = 8 * row_height;
+                    break;
+                }
+
+                switch (cvt.block_alignment) {
+                case BlockAlignment::Linear:
+                    WriteTileToOutput(output_buffer, tmp_tile, row_height, image_strip_width);
+                    output_buffer += output_stride;
+                    break;
+                case BlockAlignment::Block8x8:
+                    WriteTileToOutput(output_buffer, tmp_tile, 8, 8);
+                    output_buffer += TILE_SIZE;
+                    break;
+                }
             }
         }
 
         switch (cvt.output_format) {
         case OutputFormat::RGBA8:
-            SendData<OutputFormat::RGBA8>(memory, reinterpret_cast<u32*>(data_buffer.get()),
-                                          cvt.dst, static_cast<int>(row_data_size),
+            SendData<OutputFormat::RGBA8>(memory, output_pixels, cvt.dst,
+                                          static_cast<int>(row_data_size),
                                           static_cast<u8>(cvt.alpha));
             break;
         case OutputFormat::RGB8:
-            SendData<OutputFormat::RGB8>(memory, reinterpret_cast<u32*>(data_buffer.get()), cvt.dst,
+            SendData<OutputFormat::RGB8>(memory, output_pixels, cvt.dst,
                                          static_cast<int>(row_data_size),
                                          static_cast<u8>(cvt.alpha));
             break;
         case OutputFormat::RGB5A1:
-            SendData<OutputFormat::RGB5A1>(memory, reinterpret_cast<u32*>(data_buffer.get()),
-                                           cvt.dst, static_cast<int>(row_data_size),
+            SendData<OutputFormat::RGB5A1>(memory, output_pixels, cvt.dst,
+                                           static_cast<int>(row_data_size),
                                            static_cast<u8>(cvt.alpha));
             break;
         case OutputFormat::RGB565:
-            SendData<OutputFormat::RGB565>(memory, reinterpret_cast<u32*>(data_buffer.get()),
-                                           cvt.dst, static_cast<int>(row_data_size),
+            SendData<OutputFormat::RGB565>(memory, output_pixels, cvt.dst,
+                                           static_cast<int>(row_data_size),
                                            static_cast<u8>(cvt.alpha));
             break;
         default:
@@ -111,6 +111,13 @@ void PerfStats::EndGameFrame() {
     game_frames += 1;
 }
 
+void PerfStats::AddVertexCacheStats(u64 hits, u64 misses) {
+    std::scoped_lock lock{object_mutex};
+
+    vertex_cache_hits += hits;
+    vertex_cache_misses += misses;
+}
+
 double PerfStats::GetMeanFrametime() const {
     std::scoped_lock lock{object_mutex};
 
@@ -165,6 +172,11 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     last_stats.emulation_speed = system_us_per_second.count() / 1'000'000.0;
     last_stats.artic_transmitted = static_cast<double>(artic_transmitted) / interval;
     last_stats.artic_events.raw = artic_events.raw | prev_artic_event.raw;
+    const u64 vertex_cache_lookups = vertex_cache_hits + vertex_cache_misses;
+    last_stats.vertex_cache_hit_rate =
+        vertex_cache_lookups ? (static_cast<double>(vertex_cache_hits) /
+                                static_cast<double>(vertex_cache_lookups))
+                             : 0;
 
     // Reset counters
     reset_point = now;
@@ -176,6 +188,8 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     accumulated_gpu_time = Clock::duration::zero();
     accumulated_swap_time = Clock::duration::zero();
     game_frames = 0;
+    vertex_cache_hits = 0;
+    vertex_cache_misses = 0;
     artic_transmitted = 0;
     prev_artic_event.raw &= artic_events.raw;
 
@@ -110,6 +110,9 @@ private:
 // Returns the size of filename (64bit)
 [[nodiscard]] u64 GetSize(const std::string& filename);
 
+// Returns the last modification time of filename in seconds since the epoch, or 0 on failure
+[[nodiscard]] u64 GetModificationTime(const std::string& filename);
+
 // Overloaded GetSize, accepts file descriptor
 [[nodiscard]] u64 GetSize(int fd);
 
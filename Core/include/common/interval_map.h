@@ -0,0 +1,347 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace Common {
+
+/// Right-open interval [lower, upper) over an ordered domain.
+template <typename T>
+class Interval {
+public:
+    using domain_type = T;
+
+    constexpr Interval() = default;
+    constexpr Interval(T lower_, T upper_) : lower_bound{lower_}, upper_bound{upper_} {}
+
+    static constexpr Interval right_open(T lower, T upper) {
+        return Interval{lower, upper};
+    }
+
+    constexpr T lower() const noexcept {
+        return lower_bound;
+    }
+
+    constexpr T upper() const noexcept {
+        return upper_bound;
+    }
+
+    constexpr bool empty() const noexcept {
+        return upper_bound <= lower_bound;
+    }
+
+    constexpr T length() const noexcept {
+        return empty() ? T{} : upper_bound - lower_bound;
+    }
+
+    constexpr bool intersects(const Interval& other) const noexcept {
+        return !empty() && !other.empty() && lower_bound < other.upper_bound &&
+               other.lower_bound < upper_bound;
+    }
+
+    constexpr bool contains(const Interval& other) const noexcept {
+        return lower_bound <= other.lower_bound && other.upper_bound <= upper_bound;
+    }
+
+    /// Returns the intersection of both intervals, which is empty if they do not overlap.
+    constexpr Interval operator&(const Interval& other) const noexcept {
+        const T lower = std::max(lower_bound, other.lower_bound);
+        const T upper = std::min(upper_bound, other.upper_bound);
+        return Interval{lower, std::max(lower, upper)};
+    }
+
+    constexpr bool operator==(const Interval&) const noexcept = default;
+
+private:
+    T lower_bound{};
+    T upper_bound{};
+};
+
+namespace Detail {
+
+/// Returns the range of elements of a sorted disjoint container overlapping the interval.
+template <typename It, typename T, typename Proj>
+std::pair<It, It> OverlapRange(It begin, It end, const Interval<T>& interval, Proj&& proj) {
+    if (interval.empty()) {
+        return {end, end};
+    }
+    const It first = std::partition_point(
+        begin, end, [&](const auto& elem) { return proj(elem).upper() <= interval.lower(); });
+    const It last = std::partition_point(
+        first, end, [&](const auto& elem) { return proj(elem).lower() < interval.upper(); });
+    return {first, last};
+}
+
+} // namespace Detail
+
+/**
+ * Set of disjoint intervals stored as a sorted flat array. Touching intervals are joined, so
+ * lookups are a binary search and iterating the k intervals of a range touches contiguous memory.
+ */
+template <typename T>
+class IntervalSet {
+public:
+    using interval_type = Interval<T>;
+    using value_type = interval_type;
+    using const_iterator = typename std::vector<interval_type>::const_iterator;
+
+    IntervalSet() = default;
+    explicit IntervalSet(interval_type interval) {
+        insert(interval);
+    }
+
+    bool empty() const noexcept {
+        return intervals.empty();
+    }
+
+    std::size_t size() const noexcept {
+        return intervals.size();
+    }
+
+    const_iterator begin() const noexcept {
+        return intervals.begin();
+    }
+
+    const_iterator end() const noexcept {
+        return intervals.end();
+    }
+
+    void clear() noexcept {
+        intervals.clear();
+    }
+
+    /// Returns the range of intervals overlapping the provided interval.
+    std::pair<const_iterator, const_iterator> equal_range(interval_type interval) const {
+        return Detail::OverlapRange(intervals.begin(), intervals.end(), interval, Identity);
+    }
+
+    /// Returns the first interval overlapping the provided interval or end() if there is none.
+    const_iterator find(interval_type interval) const {
+        const auto [first, last] = equal_range(interval);
+        return first == last ? intervals.end() : first;
+    }
+
+    /// Returns true if the interval is completely covered by the set.
+    bool contains(interval_type interval) const {
+        const auto it = find(interval);
+        return it != intervals.end() && it->contains(interval);
+    }
+
+    void insert(interval_type interval) {
+        if (interval.empty()) {
+            return;
+        }
+        // Join with every interval overlapping or touching the new one.
+        auto first = std::partition_point(intervals.begin(), intervals.end(), [&](const auto& elem) {
+            return elem.upper() < interval.lower();
+        });
+        const auto last = std::partition_point(
+            first, intervals.end(), [&](const auto& elem) { return elem.lower() <= interval.upper(); });
+        if (first != last) {
+            interval = interval_type{std::min(first->lower(), interval.lower()),
+                                     std::max(std::prev(last)->upper(), interval.upper())};
+            first = intervals.erase(first, last);
+        }
+        intervals.insert(first, interval);
+    }
+
+    void erase(interval_type interval) {
+        const auto [first, last] =
+            Detail::OverlapRange(intervals.begin(), intervals.end(), interval, Identity);
+        if (first == last) {
+            return;
+        }
+        // Keep the parts of the boundary intervals outside the erased range.
+        const interval_type head{first->lower(), interval.lower()};
+        const interval_type tail{interval.upper(), std::prev(last)->upper()};
+        auto it = intervals.erase(first, last);
+        if (!tail.empty()) {
+            it = intervals.insert(it, tail);
+        }
+        if (!head.empty()) {
+            intervals.insert(it, head);
+        }
+    }
+
+    IntervalSet& operator+=(interval_type interval) {
+        insert(interval);
+        return *this;
+    }
+
+    IntervalSet& operator-=(interval_type interval) {
+        erase(interval);
+        return *this;
+    }
+
+    IntervalSet& operator-=(const IntervalSet& other) {
+        for (const interval_type& interval : other) {
+            erase(interval);
+        }
+        return *this;
+    }
+
+    IntervalSet operator-(const IntervalSet& other) const {
+        IntervalSet result = *this;
+        result -= other;
+        return result;
+    }
+
+    /// Returns the parts of the set inside the provided interval.
+    IntervalSet operator&(interval_type interval) const {
+        IntervalSet result;
+        const auto [first, last] = equal_range(interval);
+        for (auto it = first; it != last; ++it) {
+            result.intervals.push_back(*it & interval);
+        }
+        return result;
+    }
+
+private:
+    static constexpr auto Identity = [](const interval_type& interval) -> const interval_type& {
+        return interval;
+    };
+
+    std::vector<interval_type> intervals;
+};
+
+/**
+ * Map from disjoint intervals to values stored as a sorted flat array of segments.
+ *
+ * Segments holding a default constructed value are not stored and touching segments holding
+ * equal values are joined. Updating a range costs a binary search plus the number of segments
+ * it covers, while iteration runs over contiguous memory.
+ */
+template <typename K, typename V>
+class IntervalMap {
+public:
+    using interval_type = Interval<K>;
+    using value_type = std::pair<interval_type, V>;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+
+    bool empty() const noexcept {
+        return segments.empty();
+    }
+
+    std::size_t size() const noexcept {
+        return segments.size();
+    }
+
+    const_iterator begin() const noexcept {
+        return segments.begin();
+    }
+
+    const_iterator end() const noexcept {
+        return segments.end();
+    }
+
+    void clear() noexcept {
+        segments.clear();
+    }
+
+    /// Returns the range of segments overlapping the provided interval.
+    std::pair<const_iterator, const_iterator> equal_range(interval_type interval) const {
+        return Detail::OverlapRange(segments.begin(), segments.end(), interval, Key);
+    }
+
+    /// Returns the first segment overlapping the provided interval or end() if there is none.
+    const_iterator find(interval_type interval) const {
+        const auto [first, last] = equal_range(interval);
+        return first == last ? segments.end() : first;
+    }
+
+    /// Adds the value to every point of the interval.
+    void add(const value_type& segment) {
+        Update(segment.first, [&](const V& value) { return value + segment.second; });
+    }
+
+    /// Overwrites every point of the interval with the value.
+    void set(const value_type& segment) {
+        Update(segment.first, [&](const V&) { return segment.second; });
+    }
+
+    /// Removes every point of the interval from the map.
+    void erase(interval_type interval) {
+        Update(interval, [](const V&) { return V{}; });
+    }
+
+    IntervalMap& operator-=(interval_type interval) {
+        erase(interval);
+        return *this;
+    }
+
+    IntervalMap& operator-=(const IntervalSet<K>& intervals) {
+        for (const interval_type& interval : intervals) {
+            erase(interval);
+        }
+        return *this;
+    }
+
+private:
+    static constexpr auto Key = [](const value_type& segment) -> const interval_type& {
+        return segment.first;
+    };
+
+    /// Replaces the value of every point in the interval with func(value).
+    template <typename Func>
+    void Update(interval_type interval, Func&& func) {
+        if (interval.empty()) {
+            return;
+        }
+        auto [first, last] = Detail::OverlapRange(segments.begin(), segments.end(), interval, Key);
+
+        // Include the neighbours touching the interval so they can be joined with the result.
+        if (first != segments.begin() && std::prev(first)->first.upper() == interval.lower()) {
+            --first;
+        }
+        if (last != segments.end() && last->first.lower() == interval.upper()) {
+            ++last;
+        }
+
+        std::vector<value_type> replacement;
+        const auto emit = [&](interval_type range, V value) {
+            if (range.empty() || value == V{}) {
+                return;
+            }
+            if (!replacement.empty() && replacement.back().first.upper() == range.lower() &&
+                replacement.back().second == value) {
+                replacement.back().first =
+                    interval_type{replacement.back().first.lower(), range.upper()};
+                return;
+            }
+            replacement.emplace_back(range, std::move(value));
+        };
+
+        if (first != last) {
+            emit(interval_type{first->first.lower(), interval.lower()}, first->second);
+        }
+        K cursor = interval.lower();
+        for (auto it = first; it != last; ++it) {
+            const auto overlap = it->first & interval;
+            if (overlap.empty()) {
+                continue;
+            }
+            emit(interval_type{cursor, overlap.lower()}, func(V{}));
+            emit(overlap, func(it->second));
+            cursor = overlap.upper();
+        }
+        emit(interval_type{cursor, interval.upper()}, func(V{}));
+        if (first != last) {
+            const auto& back = *std::prev(last);
+            emit(interval_type{interval.upper(), back.first.upper()}, back.second);
+        }
+
+        const auto it = segments.erase(first, last);
+        segments.insert(it, std::make_move_iterator(replacement.begin()),
+                        std::make_move_iterator(replacement.end()));
+    }
+
+    std::vector<value_type> segments;
+};
+
+} // namespace Common
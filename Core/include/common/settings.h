@@ -454,6 +454,8 @@ struct Values {
 
     // Core
     Setting<bool> use_cpu_jit{true, "use_cpu_jit"};
+    Setting<bool> parallel_cpu_cores{false, "parallel_cpu_cores"};
+    Setting<bool> skip_idle_loops{false, "skip_idle_loops"};
     SwitchableSetting<s32, true> cpu_clock_percentage{100, 5, 400, "cpu_clock_percentage"};
     SwitchableSetting<bool> is_new_3ds{true, "is_new_3ds"};
     SwitchableSetting<bool> lle_applets{true, "lle_applets"};
@@ -494,6 +496,10 @@ struct Values {
     SwitchableSetting<bool> shaders_accurate_mul{true, "shaders_accurate_mul"};
     SwitchableSetting<bool> use_vsync_new{true, "use_vsync_new"};
     Setting<bool> use_shader_jit{true, "use_shader_jit"};
+    Setting<bool> async_shader_jit{false, "async_shader_jit"};
+    Setting<u32, true> shader_jit_cache_size{128, 16, 2048, "shader_jit_cache_size"};
+    Setting<u32, true> vertex_cache_size{256, 16, 4096, "vertex_cache_size"};
+    Setting<bool> parallel_vertex_shading{false, "parallel_vertex_shading"};
     SwitchableSetting<u32, true> resolution_factor{1, 0, 10, "resolution_factor"};
     SwitchableSetting<double, true> frame_limit{100, 0, 1000, "frame_limit"};
     SwitchableSetting<double, true> turbo_limit{200, 0, 1000, "turbo_limit"};
@@ -562,6 +568,8 @@ struct Values {
     SwitchableSetting<bool> custom_textures{false, "custom_textures"};
     SwitchableSetting<bool> preload_textures{false, "preload_textures"};
     SwitchableSetting<bool> async_custom_loading{true, "async_custom_loading"};
+    SwitchableSetting<bool> cache_custom_textures{false, "cache_custom_textures"};
+    Setting<u32, true> texture_prefetch_size{128, 0, 1024, "texture_prefetch_size"};
     SwitchableSetting<bool> disable_right_eye_render{false, "disable_right_eye_render"};
 
     // Audio
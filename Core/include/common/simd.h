@@ -0,0 +1,50 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/arch.h"
+
+#if CITRA_ARCH(x86_64)
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SIMD_TARGET
+#else
+#define SIMD_TARGET __attribute__((target("ssse3")))
+#endif
+#include <tmmintrin.h>
+#elif CITRA_ARCH(arm64)
+#include <arm_neon.h>
+#include "common/aarch64/cpu_detect.h"
+#define SIMD_TARGET
+#else
+#define SIMD_TARGET
+#endif
+
+namespace Common {
+
+/**
+ * Returns true if the host supports the instructions of functions marked with SIMD_TARGET,
+ * SSSE3 on x86_64 and ASIMD on arm64. The host is only queried on the first call.
+ */
+inline bool HostSupportsSimd() {
+    static const bool supported = [] {
+#if CITRA_ARCH(x86_64)
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 9)) != 0;
+#else
+        return __builtin_cpu_supports("ssse3") != 0;
+#endif
+#elif CITRA_ARCH(arm64)
+        return GetCPUCaps().asimd;
+#else
+        return false;
+#endif
+    }();
+    return supported;
+}
+
+} // namespace Common
@@ -4,7 +4,11 @@
 #pragma warning(disable : 4200)
 #endif
 
+#include <array>
 #include <cstddef>
+#include <limits>
+#include <memory>
+#include <vector>
 #include "common/common_types.h"
 
 struct ARMul_State;
@@ -490,9 +494,97 @@ struct ldst_inst {
 typedef arm_inst* ARM_INST_PTR;
 typedef ARM_INST_PTR (*transop_fp_t)(unsigned int, int);
 
+// Indices of the translators in arm_instruction_trans which take part in superinstructions.
+// arm_dyncom_trans.cpp checks them against the table.
+enum : unsigned {
+    CMP_IDX = 130,
+    TST_IDX = 131,
+    ADD_IDX = 148,
+    LDM_IDX = 161,
+    LDR_IDX = 180,
+    BBL_IDX = 196,
+};
+
 extern const transop_fp_t arm_instruction_trans[];
-extern const std::size_t arm_instruction_trans_len;
 
-#define TRANS_CACHE_SIZE (64 * 1024 * 2000)
-extern char trans_cache_buf[TRANS_CACHE_SIZE];
-extern std::size_t trans_cache_buf_top;
+// bbl is the last ARM translator, followed by the five Thumb only translators.
+constexpr std::size_t arm_instruction_trans_len = BBL_IDX + 6;
+
+/**
+ * Decoded instructions of a core. Blocks are allocated from an arena of fixed size chunks, so
+ * decoded instructions never move once their block is complete. Blocks are referenced by a handle
+ * made of the chunk index and the offset within it. The block starting at an address is found
+ * through a two level table, indexed by page and then by halfword within the page.
+ */
+class TranslationCache {
+public:
+    static constexpr u32 INVALID_BLOCK = std::numeric_limits<u32>::max();
+
+    TranslationCache();
+    ~TranslationCache();
+
+    /// Returns the handle of the block starting at the address or INVALID_BLOCK.
+    u32 Find(u32 addr) const {
+        const u32 leaf = pages[addr >> PAGE_BITS];
+        if (leaf == 0) {
+            return INVALID_BLOCK;
+        }
+        return leaves[leaf - 1][(addr & PAGE_MASK) >> 1];
+    }
+
+    /// Registers the block with the handle as the one starting at the address.
+    void Insert(u32 addr, u32 handle);
+
+    /// Forgets all blocks which may contain instructions in the range.
+    void Invalidate(u32 addr, std::size_t size);
+
+    /// Forgets all blocks and releases the arena for reuse.
+    void Clear();
+
+    /// Returns true if the arena outgrew its size limit and should be cleared.
+    bool IsFull() const {
+        return static_cast<std::size_t>(chunk_index) * CHUNK_SIZE + chunk_top >= ARENA_LIMIT;
+    }
+
+    /// Starts a new block at the end of the arena.
+    void BeginBlock() {
+        block_start = Top();
+    }
+
+    /// Returns the handle of the block being translated. It changes when the block is moved
+    /// because it didn't fit the rest of its chunk.
+    u32 BlockStart() const {
+        return block_start;
+    }
+
+    /// Allocates memory for a decoded instruction of the current block.
+    void* Allocate(std::size_t size);
+
+    /// Returns the handle the next allocation is placed at.
+    u32 Top() const {
+        return (chunk_index << CHUNK_BITS) + chunk_top;
+    }
+
+    /// Returns the memory referenced by the handle.
+    char* Pointer(u32 handle) const {
+        return chunks[handle >> CHUNK_BITS].get() + (handle & CHUNK_MASK);
+    }
+
+private:
+    static constexpr u32 PAGE_BITS = 12;
+    static constexpr u32 PAGE_MASK = (1U << PAGE_BITS) - 1;
+    static constexpr u32 CHUNK_BITS = 21;
+    static constexpr u32 CHUNK_SIZE = 1U << CHUNK_BITS;
+    static constexpr u32 CHUNK_MASK = CHUNK_SIZE - 1;
+    static constexpr std::size_t ARENA_LIMIT = 64 * 1024 * 2000;
+
+    std::vector<std::unique_ptr<char[]>> chunks;
+    u32 chunk_index{};
+    u32 chunk_top{};
+    u32 block_start{};
+    std::vector<u32> pages;
+    std::vector<std::array<u32, (1U << PAGE_BITS) / 2>> leaves;
+};
+
+/// Sets the cache the translation functions allocate decoded instructions from.
+void SetTranslationCache(TranslationCache* cache);
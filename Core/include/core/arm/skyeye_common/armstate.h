@@ -20,6 +20,7 @@
 #include <array>
 #include <unordered_map>
 #include "common/common_types.h"
+#include "core/arm/dyncom/arm_dyncom_trans.h"
 #include "core/arm/skyeye_common/arm_regformat.h"
 #include "core/gdbstub/gdbstub.h"
 
@@ -254,7 +255,14 @@ public:
 
     // TODO(bunnei): Move this cache to a better place - it should be per codeset (likely per
     // process for our purposes), not per ARMul_State (which tracks CPU core state).
-    std::unordered_map<u32, std::size_t> instruction_cache;
+    TranslationCache translation_cache;
+
+    // Whether the loops closed by the branch at each address only contain loads and register
+    // operations, and the state at the last backward branch of such a loop.
+    std::unordered_map<u32, bool> idle_loop_cache;
+    u32 idle_loop_branch = 0;
+    std::array<u32, 4> idle_loop_flags{};
+    std::array<u32, 15> idle_loop_regs{};
 
 private:
     void ResetMPCoreCP15Registers();
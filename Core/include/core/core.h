@@ -10,7 +10,10 @@
 #include <mutex>
 #include <string>
 #include <optional>
+#include <utility>
+#include <vector>
 #include "common/common_types.h"
+#include "common/polyfill_thread.h"
 #include "core/arm/arm_interface.h"
 #include "core/cheats/cheats.h"
 #include "core/hle/service/apt/applet_manager.h"
@@ -18,6 +21,10 @@
 #include "core/movie.h"
 #include "core/perf_stats.h"
 
+namespace Common {
+class Barrier;
+}
+
 namespace Frontend {
 class EmuWindow;
 class ImageInterface;
@@ -213,10 +220,24 @@ public:
         return static_cast<u32>(cpu_cores.size());
     }
 
-    void InvalidateCacheRange(u32 start_address, std::size_t length) {
-        for (const auto& cpu : cpu_cores) {
-            cpu->InvalidateCacheRange(start_address, length);
-        }
+    /**
+     * Invalidates the code translated from the range on all cores. While the cores run in
+     * parallel only the running core is invalidated right away, the others once their slices end.
+     */
+    void InvalidateCacheRange(u32 start_address, std::size_t length);
+
+    /**
+     * Serializes accesses to the emulated system from cores running on their own host threads
+     * and makes the provided core the running one while the returned lock is held. Does nothing
+     * when the cores run one after another.
+     * @param core The core about to access the emulated system.
+     * @returns The lock, which is empty when the cores do not run in parallel.
+     */
+    [[nodiscard]] std::unique_lock<std::mutex> LockCore(ARM_Interface& core);
+
+    /// Returns true when the cores run in parallel on their own host threads.
+    [[nodiscard]] bool RunsCoresInParallel() const {
+        return parallel_cores;
     }
 
     /**
@@ -392,6 +413,15 @@ private:
     /// Reschedule the core emulation
     void Reschedule();
 
+    /// Runs the next slice of the core, or idles it when there is no thread to run on it
+    void RunCoreSlice(ARM_Interface& core);
+
+    /// Runs the slices of a core on its own host thread in lockstep with the other cores
+    void CoreThread(std::stop_token stop_token, ARM_Interface& core);
+
+    /// Runs the slices of all cores in parallel until they reached the same global time
+    void RunParallelSlices(s64 max_slice);
+
     /// AppLoader used to load the current executing application
     std::unique_ptr<Loader::AppLoader> app_loader;
 
@@ -402,6 +432,16 @@ private:
     std::vector<std::shared_ptr<ARM_Interface>> cpu_cores;
     ARM_Interface* running_core = nullptr;
 
+    /// Host threads of the cores other than the first one when running the cores in parallel
+    std::vector<std::jthread> core_threads;
+    std::unique_ptr<Common::Barrier> slice_barrier;
+    std::mutex core_mutex;
+    bool parallel_cores{};
+    /// Set while the core threads execute a slice
+    bool parallel_slice_running{};
+    /// Ranges to invalidate on all cores once the current parallel slice ends
+    std::vector<std::pair<u32, std::size_t>> pending_invalidations;
+
     /// DSP core
     std::unique_ptr<AudioCore::DspInterface> dsp_core;
 
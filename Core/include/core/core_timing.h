@@ -17,15 +17,17 @@
  *   ScheduleEvent(periodInCycles - cyclesLate, callback, "whatever")
  */
 
+#include <array>
 #include <chrono>
 #include <functional>
 #include <limits>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 #include "common/common_types.h"
 #include "common/logging/log.h"
-#include "common/threadsafe_queue.h"
 #include "core/global.h"
 
 // The timing we get from the assembly is 268,111,855.956 Hz
@@ -135,6 +137,8 @@ using TimedCallback = std::function<void(std::uintptr_t user_data, int cycles_la
 struct TimingEventType {
     TimedCallback callback;
     const std::string* name;
+    /// Registration index of the type, used to look up its pending events.
+    u32 id;
 };
 
 class Timing {
@@ -173,6 +177,79 @@ public:
         BOOST_SERIALIZATION_SPLIT_MEMBER()
     };
 
+    /**
+     * Hierarchical timing wheel holding the pending events of a timer. Every level splits time in
+     * 64 slots, each level 64 times coarser than the one below, and an event is stored in the
+     * level of the highest bit where its time differs from the current time. Scheduling and
+     * cancelling an event take constant time, and the events of a slot only move down a level
+     * when the current time reaches it. Due events are kept in a small heap to preserve the
+     * order in which they fire.
+     */
+    class EventWheel {
+    public:
+        explicit EventWheel(s64 now);
+
+        /// Returns the earliest pending event or nullptr if there is none.
+        const Event* Front() const;
+
+        void Push(const Event& event);
+
+        /// Moves the current time forward, making all events up to it due.
+        void AdvanceTo(s64 now);
+
+        /// Removes the earliest due event. Returns false if no event is due.
+        bool PopDue(Event& event);
+
+        /// Removes the pending events of the type, or only those with the user data if provided.
+        void Erase(const TimingEventType* event_type, std::optional<std::uintptr_t> user_data);
+
+        /// Returns the pending events in the order they fire.
+        std::vector<Event> Events() const;
+
+        /// Removes all events and resets the current time.
+        void Clear(s64 now);
+
+    private:
+        static constexpr u32 SLOT_BITS = 6;
+        static constexpr u32 NUM_SLOTS = 1U << SLOT_BITS;
+        static constexpr u32 GRANULARITY_BITS = 12;
+        static constexpr u32 NUM_LEVELS = (63 - GRANULARITY_BITS) / SLOT_BITS + 1;
+        static constexpr u32 DUE_BUCKET = NUM_LEVELS * NUM_SLOTS;
+        static constexpr u32 FREE_BUCKET = DUE_BUCKET + 1;
+        static constexpr u32 INVALID_NODE = std::numeric_limits<u32>::max();
+
+        struct Node {
+            Event event;
+            u32 bucket;
+            u32 prev;
+            u32 next;
+            u32 type_prev;
+            u32 type_next;
+        };
+
+        /// Stores the node in the due heap or in the wheel slot matching its time.
+        void Place(u32 node);
+
+        /// Removes the node from the due heap or its wheel slot.
+        void Unlink(u32 node);
+
+        /// Removes the node from the list of its event type and returns it to the free list.
+        void Release(u32 node);
+
+        bool IsLater(u32 lhs, u32 rhs) const {
+            return nodes[lhs].event > nodes[rhs].event;
+        }
+
+        std::vector<Node> nodes;
+        std::vector<u32> due;
+        std::vector<u32> cascade;
+        std::vector<u32> type_heads;
+        std::array<u32, NUM_LEVELS * NUM_SLOTS> heads;
+        std::array<u64, NUM_LEVELS> occupied;
+        u32 free_node;
+        s64 now;
+    };
+
     // currently Service::HID::pad_update_ticks is the smallest interval for an event that gets
     // always scheduled. Therfore we use this as orientation for the MAX_SLICE_LENGTH
     // For performance bigger slice length are desired, though this will lead to cores desync
@@ -207,15 +284,20 @@ public:
 
     private:
         friend class Timing;
-        // The queue is a min-heap using std::make_heap/push_heap/pop_heap.
-        // We don't use std::priority_queue because we need to be able to serialize, unserialize and
-        // erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't
-        // accommodated by the standard adaptor class.
-        std::vector<Event> event_queue;
+
+        /// Queues an event scheduled from another thread or core until the next MoveEvents().
+        void PushThreadSafe(const Event& event);
+
+        /// Removes the pending and queued events of the type, optionally only with the user data.
+        void RemoveEvents(const TimingEventType* event_type,
+                          std::optional<std::uintptr_t> user_data);
+
+        EventWheel event_queue;
         u64 event_fifo_id = 0;
-        // the queue for storing the events from other threads threadsafe until they will be added
-        // to the event_queue by the emu thread
-        Common::MPSCQueue<Event> ts_queue;
+        // the events from other threads are stored threadsafe until they will be added to the
+        // event_queue by the emu thread
+        std::mutex ts_mutex;
+        std::vector<Event> ts_queue;
         // Are we in a function that has been called from Advance()
         // If events are sheduled from a function that gets called from Advance(),
         // don't change slice_length and downcount.
@@ -237,12 +319,19 @@ public:
         template <class Archive>
         void serialize(Archive& ar, const unsigned int) {
             MoveEvents();
-            ar & event_queue;
+            std::vector<Event> events = event_queue.Events();
+            ar & events;
             ar & event_fifo_id;
             ar & slice_length;
             ar & downcount;
             ar & executed_ticks;
             ar & idled_cycles;
+            if (Archive::is_loading::value) {
+                event_queue.Clear(executed_ticks);
+                for (const Event& event : events) {
+                    event_queue.Push(event);
+                }
+            }
         }
         // Serialization removed for libretro core
     };
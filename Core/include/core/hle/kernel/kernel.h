@@ -286,6 +286,12 @@ public:
 
     void SetRunningCPU(Core::ARM_Interface* cpu);
 
+    /**
+     * Makes the core the running one without reloading its page table, used when the cores run in
+     * parallel and enter the kernel in turns while their JIT is executing.
+     */
+    void SwapRunningCPU(Core::ARM_Interface* cpu);
+
     ThreadManager& GetThreadManager(u32 core_id);
     const ThreadManager& GetThreadManager(u32 core_id) const;
 
@@ -71,6 +71,8 @@ public:
         double emulation_speed;
         /// Artic base bytes per second
         double artic_transmitted = 0;
+        /// Ratio of indexed vertices served by the post-transform vertex cache
+        double vertex_cache_hit_rate = 0;
         /// Artic base events
         PerfArticEvents artic_events{};
     };
@@ -86,6 +88,7 @@ public:
     void BeginSystemFrame();
     void EndSystemFrame();
     void EndGameFrame();
+    void AddVertexCacheStats(u64 hits, u64 misses);
 
     Results GetAndResetStats(std::chrono::microseconds current_system_time_us);
 
@@ -143,6 +146,9 @@ private:
     u32 system_frames = 0;
     /// Cumulative number of game frames (GSP frame submissions) since last reset
     u32 game_frames = 0;
+    /// Post-transform vertex cache lookups since the last reset
+    u64 vertex_cache_hits = 0;
+    u64 vertex_cache_misses = 0;
     /// Cumulative number of transmitted artic base traffic
     std::atomic<u32> artic_transmitted = 0;
     // System events that affect performance
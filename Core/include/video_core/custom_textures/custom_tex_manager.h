@@ -4,7 +4,10 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
 #include <list>
+#include <mutex>
 #include <span>
 #include <unordered_map>
 #include <unordered_set>
@@ -29,6 +32,12 @@ struct AsyncUpload {
     std::function<bool()> func;
 };
 
+struct PrefetchedMaterial {
+    Material* material;
+    std::size_t order;
+    u64 size;
+};
+
 class CustomTexManager {
 public:
     explicit CustomTexManager(Core::System& system);
@@ -73,8 +82,34 @@ private:
     /// Parses the custom texture filename (hash, material type, etc).
     bool ParseFilename(const FileUtil::FSTEntry& file, CustomTexture* texture);
 
-    /// Returns a vector of all custom texture files.
-    std::vector<FileUtil::FSTEntry> GetTextures(u64 title_id);
+    /// Returns a vector of all custom texture files along with the directories containing them.
+    std::vector<FileUtil::FSTEntry> GetTextures(u64 title_id,
+                                                std::vector<std::string>& directories);
+
+    /// Assigns the parsed texture to the materials of its hashes.
+    void AddTexture(std::unique_ptr<CustomTexture>&& texture);
+
+    /// Restores the parsed textures from the pack index, if none of its directories changed.
+    bool LoadIndex(u64 title_id);
+
+    /// Writes the parsed textures to the pack index.
+    void WriteIndex(u64 title_id, const std::vector<std::string>& directories);
+
+    /// Reads the order in which materials were requested during previous runs of the title.
+    void LoadAccessLog(u64 title_id);
+
+    /// Saves the material access order, if materials were requested for the first time.
+    void WriteAccessLog();
+
+    /// Loads the materials in recorded access order ahead of demand, while within the budget.
+    void StartPrefetch();
+
+    /// Stops the prefetcher and keeps the materials it loaded.
+    void StopPrefetch();
+
+    /// Releases a requested material from the prefetch budget and frees prefetched materials
+    /// the title skipped over.
+    void MarkRequested(Material* material);
 
     /// Creates the thread workers.
     void CreateWorkers();
@@ -88,8 +123,22 @@ private:
     std::vector<std::unique_ptr<CustomTexture>> custom_textures;
     std::list<AsyncUpload> async_uploads;
     std::unique_ptr<Common::ThreadWorker> workers;
+    std::unique_ptr<Common::ThreadWorker> prefetch_worker;
+    std::atomic_bool stop_prefetch{false};
+    std::mutex prefetch_mutex;
+    std::condition_variable prefetch_cv;
+    std::deque<PrefetchedMaterial> prefetched;
+    std::unordered_map<const Material*, std::size_t> prefetch_order;
+    std::size_t requested_order{};
+    u64 prefetched_size{};
+    u64 prefetch_budget{};
+    std::vector<u64> access_log;
+    std::unordered_set<u64> logged_hashes;
+    std::size_t saved_log_size{};
+    u64 log_title_id{};
     bool textures_loaded{false};
     bool async_custom_loading{true};
+    bool cache_custom_textures{false};
     bool skip_mipmap{false};
     bool flip_png_files{true};
     bool use_new_hash{true};
@@ -50,11 +50,18 @@ public:
 private:
     void LoadPNG(std::span<const u8> input, bool flip_png);
 
+    /// Restores the decoded pixels of a png from the transcoding cache.
+    bool LoadCached(u64 source_size, u64 source_time, bool flip_png);
+
+    /// Saves the decoded pixels of a png to the transcoding cache.
+    void WriteCached(u64 source_size, u64 source_time, bool flip_png);
+
     void LoadDDS(std::span<const u8> input);
 
 public:
     Frontend::ImageInterface& image_interface;
     std::string path;
+    std::string cache_path;
     u32 width;
     u32 height;
     std::vector<u64> hashes;
@@ -76,12 +83,22 @@ struct Material {
 
     void LoadFromDisk(bool flip_png) noexcept;
 
+    /// Frees the loaded maps so the material is loaded again on its next use.
+    /// Returns false when a map is shared with other materials, which may be using it.
+    bool Unload() noexcept;
+
     void AddMapTexture(CustomTexture* texture) noexcept;
 
     [[nodiscard]] CustomTexture* Map(MapType type) const noexcept {
         return textures.at(static_cast<std::size_t>(type));
     }
 
+    /// Moves the material from None to Pending, true when the caller has to load it.
+    [[nodiscard]] bool TryClaim() noexcept {
+        DecodeState expected = DecodeState::None;
+        return state.compare_exchange_strong(expected, DecodeState::Pending);
+    }
+
     [[nodiscard]] bool IsPending() const noexcept {
         return state == DecodeState::Pending;
     }
@@ -95,6 +95,9 @@ public:
 
     void ReportLoadingProgramID(u64 program_ID);
 
+    /// Switches the shader caches of the renderer and the PICA core to the provided title.
+    void SwitchDiskResources(u64 title_id);
+
 private:
     void SubmitCmdList(u32 index);
 
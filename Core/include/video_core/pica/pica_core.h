@@ -4,7 +4,11 @@
 
 #pragma once
 
+#include <memory>
+#include <unordered_map>
+#include <vector>
 #include "common/common_types.h"
+#include "common/thread_worker.h"
 #include "core/hle/service/gsp/gsp_interrupt.h"
 #include "video_core/pica/dirty_regs.h"
 #include "video_core/pica/geometry_pipeline.h"
@@ -15,6 +19,8 @@
 #include "video_core/pica/regs_lcd.h"
 #include "video_core/pica/shader_setup.h"
 #include "video_core/pica/shader_unit.h"
+#include "video_core/pica/vertex_cache.h"
+#include "video_core/pica/vertex_loader.h"
 
 namespace Memory {
 class MemorySystem;
@@ -38,6 +44,8 @@ public:
 
     void SetInterruptHandler(Service::GSP::InterruptHandler& signal_interrupt);
 
+    void SwitchDiskResources(u64 title_id);
+
     void ProcessCmdList(PAddr list, u32 size, bool ignore_list);
 
 private:
@@ -294,6 +302,10 @@ public:
 
     RenderPropertiesGuess GuessCmdRenderProperties(PAddr list, u32 size);
 
+    /// Returns the hit and miss counters of the post-transform vertex caches since the last
+    /// call and resets them.
+    VertexCache::Stats TakeVertexCacheStats();
+
 private:
     Memory::MemorySystem& memory;
     VideoCore::RasterizerInterface* rasterizer;
@@ -303,6 +315,11 @@ private:
     PrimitiveAssembler primitive_assembler;
     CommandList cmd_list;
     std::unique_ptr<ShaderEngine> shader_engine;
+    VertexCache vertex_cache;
+    std::unordered_map<u64, VertexLoader> vertex_loaders;
+    std::unique_ptr<Common::ThreadWorker> vertex_workers;
+    std::vector<VertexCache> range_caches;
+    std::vector<AttributeBuffer> parallel_outputs;
 };
 
 #define GPU_REG_INDEX(field_name) (offsetof(Pica::PicaCore::Regs, field_name) / sizeof(u32))
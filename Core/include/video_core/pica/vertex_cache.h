@@ -0,0 +1,90 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+#include "video_core/pica/output_vertex.h"
+
+namespace Pica {
+
+/**
+ * Two-way set associative post-transform vertex cache keyed by vertex index.
+ * Entries are tagged with the draw they were inserted in, so invalidating the cache
+ * between draws is a constant time operation.
+ */
+class VertexCache {
+public:
+    struct Stats {
+        u64 hits;
+        u64 misses;
+    };
+
+    explicit VertexCache(u32 num_entries);
+    ~VertexCache();
+
+    /// Resizes the cache to hold at least the provided number of entries.
+    void Resize(u32 num_entries);
+
+    /// Drops all entries, must be called at the beginning of every indexed draw.
+    void Invalidate() noexcept;
+
+    /// Returns the cached shader output of the vertex or nullptr on a miss.
+    [[nodiscard]] const AttributeBuffer* Lookup(u32 vertex) noexcept {
+        const u32 set = vertex & set_mask;
+        for (u32 way = 0; way < NUM_WAYS; way++) {
+            const Entry& entry = entries[set * NUM_WAYS + way];
+            if (entry.generation == generation && entry.vertex == vertex) {
+                lru[set] = static_cast<u8>(way ^ 1);
+                stats.hits++;
+                return &entry.output;
+            }
+        }
+        stats.misses++;
+        return nullptr;
+    }
+
+    /// Inserts the shader output of the vertex, evicting the least recently used way.
+    void Insert(u32 vertex, const AttributeBuffer& output) noexcept {
+        const u32 set = vertex & set_mask;
+        const u32 way = lru[set];
+        Entry& entry = entries[set * NUM_WAYS + way];
+        entry.vertex = vertex;
+        entry.generation = generation;
+        entry.output = output;
+        lru[set] = static_cast<u8>(way ^ 1);
+    }
+
+    /// Returns the number of entries the cache can hold.
+    [[nodiscard]] u32 Size() const noexcept {
+        return static_cast<u32>(entries.size());
+    }
+
+    /// Returns the accumulated hit and miss counters.
+    [[nodiscard]] const Stats& GetStats() const noexcept {
+        return stats;
+    }
+
+    /// Resets the hit and miss counters.
+    void ResetStats() noexcept {
+        stats = {};
+    }
+
+private:
+    static constexpr u32 NUM_WAYS = 2;
+
+    struct Entry {
+        u32 vertex;
+        u32 generation;
+        AttributeBuffer output;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<u8> lru;
+    u32 set_mask{};
+    u32 generation{1};
+    Stats stats{};
+};
+
+} // namespace Pica
@@ -4,7 +4,9 @@
 
 #pragma once
 
-#include "core/memory.h"
+#include <array>
+#include <span>
+#include <boost/container/static_vector.hpp>
 #include "video_core/pica/output_vertex.h"
 #include "video_core/pica/regs_pipeline.h"
 
@@ -14,33 +16,56 @@ class MemorySystem;
 
 namespace Pica {
 
+/**
+ * Loads vertex attributes from the vertex arrays described by the pipeline registers.
+ * The attribute layout is compiled once into a list of steps, each bound to a conversion kernel
+ * specialized for the attribute format and element count, so no per vertex decoding of the
+ * configuration is required. Loaders are meant to be cached with the key returned by Hash.
+ */
 class VertexLoader {
 public:
-    explicit VertexLoader(Memory::MemorySystem& memory_, const PipelineRegs& regs);
+    explicit VertexLoader(const PipelineRegs& regs);
     ~VertexLoader();
 
-    void LoadVertex(PAddr base_address, u32 index, u32 vertex, AttributeBuffer& input,
-                    AttributeBuffer& input_default_attributes) const;
+    /// Returns the key identifying the attribute layout of the provided registers.
+    [[nodiscard]] static u64 Hash(const PipelineRegs& regs);
 
-    template <typename T>
-    void LoadAttribute(PAddr source_addr, u32 attrib, AttributeBuffer& out) const {
-        const T* data = reinterpret_cast<const T*>(memory.GetPhysicalPointer(source_addr));
-        for (u32 comp = 0; comp < vertex_attribute_elements[attrib]; ++comp) {
-            out[attrib][comp] = f24::FromFloat32(data[comp]);
-        }
-    }
+    /// Returns true if the loader was compiled for the attribute layout of the registers.
+    [[nodiscard]] bool Matches(const PipelineRegs& regs) const;
+
+    /// Resolves the host pointers of the vertex arrays, must be called before every batch.
+    void Bind(Memory::MemorySystem& memory, PAddr base_address);
+
+    /// Loads the attributes of the vertex into the input buffer.
+    void LoadVertex(u32 vertex, AttributeBuffer& input,
+                    const AttributeBuffer& input_default_attributes) const;
+
+    /// Loads the attributes of consecutive vertices starting at first_vertex, one input buffer
+    /// per vertex. Each attribute array is walked linearly, as used by non-indexed draws.
+    void LoadVertices(u32 first_vertex, std::span<AttributeBuffer> inputs,
+                      const AttributeBuffer& input_default_attributes) const;
 
     int GetNumTotalAttributes() const {
         return num_total_attributes;
     }
 
 private:
-    Memory::MemorySystem& memory;
-    std::array<u32, 16> vertex_attribute_sources;
-    std::array<u32, 16> vertex_attribute_strides{};
-    std::array<PipelineRegs::VertexAttributeFormat, 16> vertex_attribute_formats;
-    std::array<u32, 16> vertex_attribute_elements{};
-    std::array<bool, 16> vertex_attribute_is_default;
+    using LoadFunc = void (*)(const u8* source, Common::Vec4<f24>& out);
+
+    struct Step {
+        LoadFunc load;        ///< Conversion kernel, nullptr for default attributes
+        u32 attribute;        ///< Input register written by this step
+        u32 source_offset;    ///< Offset of the first element from the base address
+        u32 stride;           ///< Distance between two vertices in bytes
+        const u8* source_ptr; ///< Host pointer of the first element, set by Bind
+    };
+
+    /// Attribute registers without the base address, which is resolved by Bind.
+    static constexpr std::size_t LAYOUT_SIZE =
+        sizeof(PipelineRegs::vertex_attributes) - sizeof(u32);
+
+    std::array<u8, LAYOUT_SIZE> layout;
+    boost::container::static_vector<Step, 16> steps;
     int num_total_attributes = 0;
 };
 
@@ -0,0 +1,27 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+#include "video_core/rasterizer_cache/pixel_format.h"
+
+namespace VideoCore {
+
+/**
+ * Swizzles or unswizzles a single 8x8 tile.
+ * @param stride The width of the linear buffer in pixels
+ * @param tile The tiled pixel data
+ * @param linear The first pixel of the top tile row in the linear buffer, which is stored bottom up
+ */
+using MortonTileFunc = void (*)(u32 stride, u8* tile, u8* linear);
+
+/**
+ * Returns a vectorized equivalent of MortonCopyTile for the provided configuration, or nullptr
+ * when the host CPU lacks the required instructions or the format conversion is not a plain byte
+ * shuffle. The scalar MortonCopyTile remains the reference implementation and fallback.
+ */
+MortonTileFunc GetMortonTileFunc(bool morton_to_linear, PixelFormat format, bool converted);
+
+} // namespace VideoCore
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <thread>
 #include <type_traits>
 #include <boost/container/small_vector.hpp>
 #include <boost/range/iterator_range.hpp>
@@ -28,8 +30,14 @@ MICROPROFILE_DECLARE(RasterizerCache_UploadSurface);
 MICROPROFILE_DECLARE(RasterizerCache_DownloadSurface);
 MICROPROFILE_DECLARE(RasterizerCache_Invalidation);
 
+/// Minimum number of pixels of a tiled upload for its decode to be split across threads.
+constexpr u32 PARALLEL_DECODE_PIXELS = 256 * 256;
+
+/// Maximum number of addresses whose legacy texture hash is remembered.
+constexpr std::size_t MAX_LEGACY_HASHES = 4096;
+
 constexpr auto RangeFromInterval(const auto& map, const auto& interval) {
-    return // removed boost::make_iterator_range(map.equal_range(interval));
+    return boost::make_iterator_range(map.equal_range(interval));
 }
 
 template <class T>
@@ -89,6 +97,9 @@ void RasterizerCache<T>::TickFrame() {
     custom_tex_manager.TickFrame();
     RunGarbageCollector();
 
+    // Readbacks that were not used within a frame are unlikely to be used at all.
+    DiscardReadbacks([this](const Readback& readback) { return frame_tick - readback.frame > 1; });
+
     const auto new_filter = Settings::values.texture_filter.GetValue();
     if (filter != new_filter) [[unlikely]] {
         filter = new_filter;
@@ -262,6 +273,7 @@ bool RasterizerCache<T>::AccelerateTextureCopy(const Pica::DisplayTransferConfig
     runtime.CopyTextures(src_surface, dst_surface, texture_copy);
 
     InvalidateRegion(dst_params.addr, dst_params.size, dst_surface_id);
+    QueueReadback(dst_surface_id);
     return true;
 }
 
@@ -332,6 +344,7 @@ bool RasterizerCache<T>::AccelerateDisplayTransfer(const Pica::DisplayTransferCo
     runtime.BlitTextures(src_surface, dst_surface, texture_blit);
 
     InvalidateRegion(dst_params.addr, dst_params.size, dst_surface_id);
+    QueueReadback(dst_surface_id);
     return true;
 }
 
@@ -662,7 +675,7 @@ typename T::Surface& RasterizerCache<T>::GetTextureCube(const TextureCubeConfig&
             continue;
         }
         cube.ticks[i] = surface.modification_tick;
-        // removed boost::container::small_vector<TextureCopy, 8> upload_copies;
+        boost::container::small_vector<TextureCopy, 8> upload_copies;
         for (u32 level = 0; level < config.levels; level++) {
             const u32 width_lod = surface.GetScaledWidth() >> level;
             upload_copies.push_back({
@@ -748,17 +761,23 @@ FramebufferHelper<T> RasterizerCache<T>::GetFramebufferSurfaces(bool using_color
     if (color_id) {
         color_level = color_surface->LevelOf(color_params.addr);
         color_surface->flags |= SurfaceFlagBits::RenderTarget;
-        ValidateSurface(color_id, // removed boost::icl::first(color_vp_interval),
-                        // removed boost::icl::length(color_vp_interval));
+        ValidateSurface(color_id, color_vp_interval.lower(), color_vp_interval.length());
     }
     if (depth_id) {
         depth_level = depth_surface->LevelOf(depth_params.addr);
         depth_surface->flags |= SurfaceFlagBits::RenderTarget;
-        ValidateSurface(depth_id, // removed boost::icl::first(depth_vp_interval),
-                        // removed boost::icl::length(depth_vp_interval));
+        ValidateSurface(depth_id, depth_vp_interval.lower(), depth_vp_interval.length());
+    }
+
+    // Rendering to the previous targets is done, start reading back the ones the CPU will want.
+    if (fb_params.color_id != color_id) {
+        QueueReadback(fb_params.color_id);
+    }
+    if (fb_params.depth_id != depth_id) {
+        QueueReadback(fb_params.depth_id);
     }
 
-    const FramebufferParams fb_params = {
+    fb_params = {
         .color_id = color_id,
         .depth_id = depth_id,
         .color_level = color_level,
@@ -809,17 +828,9 @@ template <typename Func>
 void RasterizerCache<T>::ForEachSurfaceInRegion(PAddr addr, std::size_t size, Func&& func) {
     using FuncReturn = typename std::invoke_result<Func, SurfaceId, Surface&>::type;
     static constexpr bool BOOL_BREAK = std::is_same_v<FuncReturn, bool>;
-    // removed boost::container::small_vector<SurfaceId, 8> surfaces;
+    boost::container::small_vector<SurfaceId, 8> surfaces;
     ForEachPage(addr, size, [this, &surfaces, addr, size, func](u64 page) {
-        const auto it = page_table.find(page);
-        if (it == page_table.end()) {
-            if constexpr (BOOL_BREAK) {
-                return false;
-            } else {
-                return;
-            }
-        }
-        for (const SurfaceId surface_id : it->second) {
+        for (const SurfaceId surface_id : page_table.Surfaces(page)) {
             Surface& surface = slot_surfaces[surface_id];
             if (True(surface.flags & SurfaceFlagBits::Picked)) {
                 continue;
@@ -901,7 +912,7 @@ SurfaceId RasterizerCache<T>::FindMatch(const SurfaceParams& params, ScaleMatch
                 return;
             }
 
-            if (// removed boost::icl::length(surface_interval) > // removed boost::icl::length(match_interval)) {
+            if (surface_interval.length() > match_interval.length()) {
                 UpdateMatch();
             }
         };
@@ -915,7 +926,7 @@ SurfaceId RasterizerCache<T>::FindMatch(const SurfaceParams& params, ScaleMatch
             ASSERT(validate_interval);
             const SurfaceInterval copy_interval =
                 surface.GetCopyableInterval(params.FromInterval(*validate_interval));
-            const bool matched = // removed boost::icl::length(copy_interval & *validate_interval) != 0 &&
+            const bool matched = (copy_interval & *validate_interval).length() != 0 &&
                                  surface.CanCopy(params, copy_interval);
             return std::make_pair(matched, copy_interval);
         });
@@ -923,7 +934,7 @@ SurfaceId RasterizerCache<T>::FindMatch(const SurfaceParams& params, ScaleMatch
             ASSERT(validate_interval);
             const SurfaceInterval copy_interval =
                 surface.GetCopyableInterval(params.FromInterval(*validate_interval));
-            const bool matched = // removed boost::icl::length(copy_interval & *validate_interval) != 0 &&
+            const bool matched = (copy_interval & *validate_interval).length() != 0 &&
                                  surface.CanReinterpret(params);
             return std::make_pair(matched, copy_interval);
         });
@@ -971,7 +982,7 @@ void RasterizerCache<T>::ValidateSurface(SurfaceId surface_id, PAddr addr, u32 s
         // to the current level interval. If the interval is empty
         // then we have validated the entire level so move to the next.
         const auto interval = *validate_regions.begin() & level_interval;
-        if (// removed boost::icl::is_empty(interval)) {
+        if (interval.empty()) {
             level_interval = surface.LevelInterval(++level);
             continue;
         }
@@ -1025,13 +1036,13 @@ void RasterizerCache<T>::UploadSurface(Surface& surface, SurfaceInterval interva
     }
 
     const auto upload_data = source_ptr.GetWriteBytes(load_info.end - load_info.addr);
-    DecodeTexture(load_info, load_info.addr, load_info.end, upload_data, staging.mapped,
+    DecodeSurface(load_info, upload_data, staging.mapped,
                   runtime.NeedsConversion(surface.pixel_format));
 
     const bool should_dump = False(surface.flags & SurfaceFlagBits::Custom) &&
                              False(surface.flags & SurfaceFlagBits::RenderTarget);
     if (dump_textures && should_dump) {
-        const u64 hash = ComputeHash(load_info, upload_data);
+        const u64 hash = ComputeHash(surface, load_info, upload_data);
         const u32 level = surface.LevelOf(load_info.addr);
         custom_tex_manager.DumpTexture(load_info, level, upload_data, hash);
     }
@@ -1046,17 +1057,102 @@ void RasterizerCache<T>::UploadSurface(Surface& surface, SurfaceInterval interva
 }
 
 template <class T>
-u64 RasterizerCache<T>::ComputeHash(const SurfaceParams& load_info, std::span<u8> upload_data) {
-    if (!custom_tex_manager.UseNewHash()) {
-        const u32 width = load_info.width;
-        const u32 height = load_info.height;
-        const u32 bpp = GetFormatBytesPerPixel(load_info.pixel_format);
-        auto decoded = std::vector<u8>(width * height * bpp);
-        DecodeTexture(load_info, load_info.addr, load_info.end, upload_data, decoded, false);
-        return Common::ComputeHash64(decoded.data(), decoded.size());
-    } else {
-        return Common::ComputeHash64(upload_data.data(), upload_data.size());
+void RasterizerCache<T>::DecodeSurface(const SurfaceParams& load_info, std::span<u8> upload_data,
+                                       std::span<u8> dest, bool convert) {
+    const u32 tile_rows = load_info.height / 8;
+    if (!load_info.is_tiled || load_info.width != load_info.stride || tile_rows < 2 ||
+        load_info.width * load_info.height < PARALLEL_DECODE_PIXELS) {
+        DecodeTexture(load_info, load_info.addr, load_info.end, upload_data, dest, convert);
+        return;
+    }
+
+    if (!decode_workers) {
+        const u32 num_workers = std::max(std::thread::hardware_concurrency(), 2U) - 1;
+        decode_workers = std::make_unique<Common::ThreadWorker>(num_workers, "TextureDecode");
+    }
+
+    // Split the surface in bands of whole tile rows, one per worker plus one for this thread.
+    // The linear output is stored bottom up, so the first band goes at the end of dest.
+    const u32 num_bands = std::min(tile_rows, static_cast<u32>(decode_workers->NumWorkers()) + 1);
+    const u32 band_rows = (tile_rows + num_bands - 1) / num_bands;
+    const u32 linear_bpp = convert ? 4 : GetFormatBytesPerPixel(load_info.pixel_format);
+    const u32 tiled_row_size = load_info.BytesInPixels(load_info.width * 8);
+    const u32 linear_row_size = load_info.width * 8 * linear_bpp;
+
+    const auto decode_band = [load_info, upload_data, dest, convert, tile_rows, tiled_row_size,
+                              linear_row_size](u32 first_row, u32 num_rows) {
+        SurfaceParams band_info = load_info;
+        band_info.addr = load_info.addr + first_row * tiled_row_size;
+        band_info.end = band_info.addr + num_rows * tiled_row_size;
+        band_info.height = num_rows * 8;
+
+        const u32 linear_offset = (tile_rows - first_row - num_rows) * linear_row_size;
+        DecodeTexture(band_info, band_info.addr, band_info.end,
+                      upload_data.subspan(first_row * tiled_row_size, num_rows * tiled_row_size),
+                      dest.subspan(linear_offset, num_rows * linear_row_size), convert);
+    };
+
+    for (u32 first_row = band_rows; first_row < tile_rows; first_row += band_rows) {
+        const u32 num_rows = std::min(band_rows, tile_rows - first_row);
+        decode_workers->QueueWork(
+            [decode_band, first_row, num_rows] { decode_band(first_row, num_rows); });
+    }
+    decode_band(0, std::min(band_rows, tile_rows));
+    decode_workers->WaitForRequests();
+}
+
+template <class T>
+u64 RasterizerCache<T>::ComputeHash(Surface& surface, const SurfaceParams& load_info,
+                                    std::span<u8> upload_data) {
+    const bool new_hash = custom_tex_manager.UseNewHash();
+    const SurfaceInterval interval = load_info.GetInterval();
+    if (const auto cached_hash = surface.GetCachedHash(interval, new_hash)) {
+        return *cached_hash;
+    }
+
+    u64 hash = Common::ComputeHash64(upload_data.data(), upload_data.size());
+    if (!new_hash) {
+        // The legacy hash covers the decoded texture, which only depends on the guest data and
+        // its layout. Textures that are invalidated and uploaded again unchanged, possibly into a
+        // new surface, reuse the hash computed last time instead of decoding again.
+        const LegacyHash key = {
+            .size = static_cast<u32>(upload_data.size()),
+            .width = load_info.width,
+            .height = load_info.height,
+            .stride = load_info.stride,
+            .pixel_format = load_info.pixel_format,
+            .is_tiled = load_info.is_tiled,
+            .data_hash = hash,
+        };
+        const auto matches = [&key](const LegacyHash& entry) {
+            return entry.size == key.size && entry.width == key.width &&
+                   entry.height == key.height && entry.stride == key.stride &&
+                   entry.pixel_format == key.pixel_format && entry.is_tiled == key.is_tiled &&
+                   entry.data_hash == key.data_hash;
+        };
+        const auto it = legacy_hashes.find(load_info.addr);
+        if (it != legacy_hashes.end() && matches(it->second)) {
+            hash = it->second.hash;
+        } else {
+            // Decode into a buffer that is kept around between uploads, cleared first to match
+            // a freshly allocated one.
+            const u32 width = load_info.width;
+            const u32 height = load_info.height;
+            const u32 bpp = GetFormatBytesPerPixel(load_info.pixel_format);
+            hash_scratch.assign(width * height * bpp, 0);
+            DecodeSurface(load_info, upload_data, hash_scratch, false);
+            hash = Common::ComputeHash64(hash_scratch.data(), hash_scratch.size());
+
+            if (it == legacy_hashes.end() && legacy_hashes.size() >= MAX_LEGACY_HASHES) {
+                legacy_hashes.clear();
+            }
+            LegacyHash& entry = legacy_hashes[load_info.addr];
+            entry = key;
+            entry.hash = hash;
+        }
     }
+    surface.CacheHash(interval, new_hash, hash);
+    return hash;
 }
 
 template <class T>
@@ -1073,7 +1169,7 @@ bool RasterizerCache<T>::UploadCustomSurface(SurfaceId surface_id, SurfaceInterv
     }
 
     const auto upload_data = source_ptr.GetWriteBytes(load_info.end - load_info.addr);
-    const u64 hash = ComputeHash(load_info, upload_data);
+    const u64 hash = ComputeHash(surface, load_info, upload_data);
 
     const u32 level = surface.LevelOf(load_info.addr);
     Material* material = custom_tex_manager.GetMaterial(hash);
@@ -1112,12 +1208,12 @@ void RasterizerCache<T>::DownloadSurface(Surface& surface, SurfaceInterval inter
     MICROPROFILE_SCOPE(RasterizerCache_DownloadSurface);
 
     const SurfaceParams flush_info = surface.FromInterval(interval);
-    const u32 flush_start = // removed boost::icl::first(interval);
-    const u32 flush_end = // removed boost::icl::last_next(interval);
+    const u32 flush_start = interval.lower();
+    const u32 flush_end = interval.upper();
     ASSERT(flush_start >= surface.addr && flush_end <= surface.end);
 
-    const auto staging = runtime.FindStaging(
-        flush_info.width * flush_info.height * surface.GetInternalBytesPerPixel(), false);
+    const auto staging = FindDownloadStaging(flush_info.width * flush_info.height *
+                                             surface.GetInternalBytesPerPixel());
 
     const BufferTextureCopy download = {
         .buffer_offset = staging.offset,
@@ -1137,10 +1233,130 @@ void RasterizerCache<T>::DownloadSurface(Surface& surface, SurfaceInterval inter
                   runtime.NeedsConversion(surface.pixel_format));
 }
 
+template <class T>
+StagingData RasterizerCache<T>::FindDownloadStaging(u32 size) {
+    const StagingData staging = runtime.FindStaging(size, false);
+    const u32 staging_end = staging.offset + staging.size;
+    DiscardReadbacks([&](const Readback& readback) {
+        return readback.staging.offset < staging_end &&
+               staging.offset < readback.staging.offset + readback.staging.size;
+    });
+    return staging;
+}
+
+template <class T>
+void RasterizerCache<T>::QueueReadback(SurfaceId surface_id) {
+    if (!surface_id) {
+        return;
+    }
+    Surface& surface = slot_surfaces[surface_id];
+    if (False(surface.flags & SurfaceFlagBits::Readback) || surface.type == SurfaceType::Fill) {
+        return;
+    }
+
+    const SurfaceInterval surface_interval = surface.GetInterval();
+    bool queued = false;
+    for (const auto& [region, owner_id] : RangeFromInterval(dirty_regions, surface_interval)) {
+        if (owner_id != surface_id) {
+            continue;
+        }
+        const auto interval = region & surface_interval;
+        const u32 start_level = surface.LevelOf(interval.lower());
+        const u32 end_level = surface.LevelOf(interval.upper());
+        for (u32 level = start_level; level <= end_level; level++) {
+            const auto download_interval = interval & surface.LevelInterval(level);
+            if (download_interval.empty()) {
+                continue;
+            }
+            const bool pending = std::ranges::any_of(readbacks, [&](const Readback& readback) {
+                return readback.surface_id == surface_id &&
+                       readback.interval.contains(download_interval);
+            });
+            if (pending) {
+                continue;
+            }
+
+            const SurfaceParams flush_info = surface.FromInterval(download_interval);
+            const u32 size =
+                flush_info.width * flush_info.height * surface.GetInternalBytesPerPixel();
+            if (readback_bytes + size > READBACK_BUDGET) {
+                break;
+            }
+
+            const auto staging = FindDownloadStaging(size);
+            const BufferTextureCopy download = {
+                .buffer_offset = staging.offset,
+                .buffer_size = staging.size,
+                .texture_rect = surface.GetSubRect(flush_info),
+                .texture_level = level,
+            };
+            const u64 tick = surface.DownloadAsync(download, staging);
+            readbacks.push_back(Readback{
+                .surface_id = surface_id,
+                .interval = download_interval,
+                .staging = staging,
+                .tick = tick,
+                .frame = frame_tick,
+                .used = false,
+            });
+            readback_bytes += size;
+            queued = true;
+        }
+    }
+
+    if (queued) {
+        runtime.Flush();
+    }
+}
+
+template <class T>
+bool RasterizerCache<T>::FinishReadback(SurfaceId surface_id, SurfaceInterval interval) {
+    Surface& surface = slot_surfaces[surface_id];
+    const auto it = std::ranges::find_if(readbacks, [&](const Readback& readback) {
+        // Linear encoding always writes the whole readback, so it must match exactly.
+        return readback.surface_id == surface_id && readback.interval.contains(interval) &&
+               (surface.is_tiled || readback.interval == interval);
+    });
+    if (it == readbacks.end()) {
+        return false;
+    }
+
+    MICROPROFILE_SCOPE(RasterizerCache_DownloadSurface);
+    it->used = true;
+
+    MemoryRef dest_ptr = memory.GetPhysicalRef(interval.lower());
+    if (!dest_ptr) [[unlikely]] {
+        return true;
+    }
+
+    runtime.WaitDownload(it->tick, it->staging);
+    const SurfaceParams flush_info = surface.FromInterval(it->interval);
+    const auto download_dest = dest_ptr.GetWriteBytes(interval.upper() - interval.lower());
+    EncodeTexture(flush_info, interval.lower(), interval.upper(), it->staging.mapped,
+                  download_dest, runtime.NeedsConversion(surface.pixel_format));
+    return true;
+}
+
+template <class T>
+template <typename Pred>
+void RasterizerCache<T>::DiscardReadbacks(Pred&& pred) {
+    std::erase_if(readbacks, [&](const Readback& readback) {
+        if (!pred(readback)) {
+            return false;
+        }
+        // Stop reading back surfaces whose readbacks go unused.
+        if (!readback.used) {
+            slot_surfaces[readback.surface_id].flags &= ~SurfaceFlagBits::Readback;
+        }
+        readback_bytes -= readback.staging.size;
+        return true;
+    });
+}
+
 template <class T>
 void RasterizerCache<T>::DownloadFillSurface(Surface& surface, SurfaceInterval interval) {
-    const u32 flush_start = // removed boost::icl::first(interval);
-    const u32 flush_end = // removed boost::icl::last_next(interval);
+    const u32 flush_start = interval.lower();
+    const u32 flush_end = interval.upper();
     ASSERT(flush_start >= surface.addr && flush_end <= surface.end);
 
     MemoryRef dest_ptr = memory.GetPhysicalRef(flush_start);
@@ -1177,14 +1393,14 @@ bool RasterizerCache<T>::ValidateByReinterpretation(Surface& surface, SurfacePar
     if (reinterpret_id) {
         Surface& src_surface = slot_surfaces[reinterpret_id];
         const SurfaceInterval copy_interval = src_surface.GetCopyableInterval(params);
-        if (// removed boost::icl::is_empty(copy_interval & interval)) {
+        if ((copy_interval & interval).empty()) {
             return false;
         }
         const u32 res_scale = src_surface.res_scale;
         if (res_scale > surface.res_scale) {
             surface.ScaleUp(res_scale);
         }
-        const PAddr addr = // removed boost::icl::lower(interval);
+        const PAddr addr = interval.lower();
         const SurfaceParams copy_params = surface.FromInterval(copy_interval);
         const auto src_rect = src_surface.GetScaledSubRect(copy_params);
         const auto dst_rect = surface.GetScaledSubRect(copy_params);
@@ -1222,8 +1438,8 @@ void RasterizerCache<T>::ClearAll(bool flush) {
     for (auto& pair : RangeFromInterval(cached_pages, flush_interval)) {
         const auto interval = pair.first & flush_interval;
 
-        const PAddr interval_start_addr = // removed boost::icl::first(interval) << Memory::CITRA_PAGE_BITS;
-        const PAddr interval_end_addr = // removed boost::icl::last_next(interval) << Memory::CITRA_PAGE_BITS;
+        const PAddr interval_start_addr = interval.lower() << Memory::CITRA_PAGE_BITS;
+        const PAddr interval_end_addr = interval.upper() << Memory::CITRA_PAGE_BITS;
         const u32 interval_size = interval_end_addr - interval_start_addr;
 
         memory.RasterizerMarkRegionCached(interval_start_addr, interval_size, false);
@@ -1232,7 +1448,9 @@ void RasterizerCache<T>::ClearAll(bool flush) {
     // Remove the whole cache without really looking at it.
     cached_pages -= flush_interval;
     dirty_regions.clear();
-    page_table.clear();
+    page_table.Clear();
+    readbacks.clear();
+    readback_bytes = 0;
 }
 
 template <class T>
@@ -1271,10 +1489,13 @@ void RasterizerCache<T>::FlushRegion(PAddr addr, u32 size, SurfaceId flush_surfa
         const u32 end_level = surface.LevelOf(interval.upper());
         for (u32 level = start_level; level <= end_level; level++) {
             const auto download_interval = interval & surface.LevelInterval(level);
-            if (// removed boost::icl::is_empty(download_interval)) {
+            if (download_interval.empty()) {
                 continue;
             }
-            DownloadSurface(surface, download_interval);
+            if (!FinishReadback(surface_id, download_interval)) {
+                DownloadSurface(surface, download_interval);
+                surface.flags |= SurfaceFlagBits::Readback;
+            }
         }
     }
 
@@ -1303,7 +1524,7 @@ void RasterizerCache<T>::InvalidateRegion(PAddr addr, u32 size, SurfaceId region
         region_owner.MarkValid(invalid_interval);
     }
 
-    // removed boost::container::small_vector<SurfaceId, 4> remove_surfaces;
+    boost::container::small_vector<SurfaceId, 4> remove_surfaces;
     ForEachSurfaceInRegion(addr, size, [&](SurfaceId surface_id, Surface& surface) {
         if (surface_id == region_owner_id) {
             return;
@@ -1328,6 +1549,9 @@ void RasterizerCache<T>::InvalidateRegion(PAddr addr, u32 size, SurfaceId region
     } else {
         dirty_regions.erase(invalid_interval);
     }
+    DiscardReadbacks([&](const Readback& readback) {
+        return readback.interval.intersects(invalid_interval);
+    });
 
     for (const SurfaceId surface_id : remove_surfaces) {
         UnregisterSurface(surface_id);
@@ -1364,7 +1588,7 @@ void RasterizerCache<T>::RegisterSurface(SurfaceId surface_id) {
     surface.flags |= SurfaceFlagBits::Registered;
     UpdatePagesCachedCount(surface.addr, surface.size, 1);
     ForEachPage(surface.addr, surface.size,
-                [this, surface_id](u64 page) { page_table[page].push_back(surface_id); });
+                [this, surface_id](u64 page) { page_table.Insert(page, surface_id); });
 }
 
 template <class T>
@@ -1375,20 +1599,19 @@ void RasterizerCache<T>::UnregisterSurface(SurfaceId surface_id) {
 
     surface.flags &= ~SurfaceFlagBits::Registered;
     UpdatePagesCachedCount(surface.addr, surface.size, -1);
+    DiscardReadbacks(
+        [surface_id](const Readback& readback) { return readback.surface_id == surface_id; });
+    if (fb_params.color_id == surface_id) {
+        fb_params.color_id = SurfaceId{};
+    }
+    if (fb_params.depth_id == surface_id) {
+        fb_params.depth_id = SurfaceId{};
+    }
     ForEachPage(surface.addr, surface.size, [this, surface_id](u64 page) {
-        const auto page_it = page_table.find(page);
-        if (page_it == page_table.end()) {
-            ASSERT_MSG(false, "Unregistering unregistered page=0x{:x}", page << CITRA_PAGEBITS);
-            return;
-        }
-        std::vector<SurfaceId>& surfaces = page_it.value();
-        const auto vector_it = std::find(surfaces.begin(), surfaces.end(), surface_id);
-        if (vector_it == surfaces.end()) {
+        if (!page_table.Erase(page, surface_id)) {
             ASSERT_MSG(false, "Unregistering unregistered surface in page=0x{:x}",
                        page << CITRA_PAGEBITS);
-            return;
         }
-        surfaces.erase(vector_it);
     });
 
     if (surface.type != SurfaceType::Fill) {
@@ -1403,9 +1626,9 @@ void RasterizerCache<T>::UnregisterSurface(SurfaceId surface_id) {
 template <class T>
 void RasterizerCache<T>::UnregisterAll() {
     FlushAll();
-    for (auto& [page, surfaces] : page_table) {
-        while (!surfaces.empty()) {
-            UnregisterSurface(surfaces.back());
+    for (u64 page = 0; page < SurfacePageTable::NUM_PAGES; ++page) {
+        while (const SurfaceId surface_id = page_table.Back(page)) {
+            UnregisterSurface(surface_id);
         }
     }
     runtime.Finish();
@@ -1431,8 +1654,8 @@ void RasterizerCache<T>::UpdatePagesCachedCount(PAddr addr, u32 size, int delta)
         const auto interval = pair.first & pages_interval;
         const int count = pair.second;
 
-        const PAddr interval_start_addr = // removed boost::icl::first(interval) << Memory::CITRA_PAGE_BITS;
-        const PAddr interval_end_addr = // removed boost::icl::last_next(interval) << Memory::CITRA_PAGE_BITS;
+        const PAddr interval_start_addr = interval.lower() << Memory::CITRA_PAGE_BITS;
+        const PAddr interval_end_addr = interval.upper() << Memory::CITRA_PAGE_BITS;
         const u32 interval_size = interval_end_addr - interval_start_addr;
 
         if (delta > 0 && count == delta) {
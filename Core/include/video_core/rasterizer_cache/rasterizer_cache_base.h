@@ -6,17 +6,20 @@
 
 #include <functional>
 #include <list>
+#include <memory>
 #include <optional>
 #include <span>
 #include <unordered_map>
 #include <vector>
-#include <boost/icl/interval_map.hpp>
-#include <tsl/robin_map.h>
 
+#include "common/interval_map.h"
+#include "common/thread_worker.h"
 #include "video_core/rasterizer_cache/framebuffer_base.h"
 #include "video_core/rasterizer_cache/sampler_params.h"
+#include "video_core/rasterizer_cache/surface_page_table.h"
 #include "video_core/rasterizer_cache/surface_params.h"
 #include "video_core/rasterizer_cache/texture_cube.h"
+#include "video_core/rasterizer_cache/utils.h"
 
 namespace Memory {
 class MemorySystem;
@@ -59,8 +62,8 @@ class RendererBase;
 
 template <class T>
 class RasterizerCache {
-    /// Address shift for caching surfaces into a hash table
-    static constexpr u64 CITRA_PAGEBITS = 18;
+    /// Address shift of the pages tracked by the surface page table
+    static constexpr u64 CITRA_PAGEBITS = SurfacePageTable::PAGE_BITS;
 
     using Runtime = typename T::Runtime;
     using Sampler = typename T::Sampler;
@@ -68,10 +71,12 @@ class RasterizerCache {
     using Framebuffer = typename T::Framebuffer;
     using DebugScope = typename T::DebugScope;
 
-    // Simplified surface map for libretro core
-    using SurfaceMap = std::map<PAddr, SurfaceId>;
+    /// Maximum amount of staging memory held by queued readbacks
+    static constexpr u32 READBACK_BUDGET = 4 * 1024 * 1024;
+
+    using SurfaceMap = Common::IntervalMap<PAddr, SurfaceId>;
     using SurfaceRect_Tuple = std::pair<SurfaceId, Common::Rectangle<u32>>;
-    using PageMap = std::map<u32, int>;
+    using PageMap = Common::IntervalMap<u32, int>;
 
 public:
     explicit RasterizerCache(Memory::MemorySystem& memory, CustomTexManager& custom_tex_manager,
@@ -169,8 +174,9 @@ private:
     /// Removes any references of the provided surface id from cached texture cubes.
     void RemoveTextureCubeFace(SurfaceId surface_id);
 
-    /// Computes the hash of the provided texture data.
-    u64 ComputeHash(const SurfaceParams& load_info, std::span<u8> upload_data);
+    /// Computes the hash of the provided texture data, reusing the one cached in the surface
+    /// when the data was not invalidated since, or the legacy hash of identical guest data.
+    u64 ComputeHash(Surface& surface, const SurfaceParams& load_info, std::span<u8> upload_data);
 
     /// Update surface's texture for given region when necessary
     void ValidateSurface(SurfaceId surface, PAddr addr, u32 size);
@@ -178,6 +184,10 @@ private:
     /// Copies pixel data in interval from the guest VRAM to the host GPU surface
     void UploadSurface(Surface& surface, SurfaceInterval interval);
 
+    /// Decodes the guest data of load_info, splitting large tiled surfaces across worker threads
+    void DecodeSurface(const SurfaceParams& load_info, std::span<u8> upload_data,
+                       std::span<u8> dest, bool convert);
+
     /// Uploads a custom texture identified with hash to the target surface
     bool UploadCustomSurface(SurfaceId surface_id, SurfaceInterval interval);
 
@@ -187,6 +197,20 @@ private:
     /// Downloads a fill surface to guest VRAM
     void DownloadFillSurface(Surface& surface, SurfaceInterval interval);
 
+    /// Maps download staging memory, discarding readbacks whose staging memory it reuses
+    StagingData FindDownloadStaging(u32 size);
+
+    /// Starts asynchronous downloads of the dirty regions of a surface previously read back
+    void QueueReadback(SurfaceId surface_id);
+
+    /// Copies interval to the guest VRAM from a queued readback of the surface, waiting for it
+    /// if the copy is still in flight. Returns false when no queued readback covers interval.
+    bool FinishReadback(SurfaceId surface_id, SurfaceInterval interval);
+
+    /// Discards the queued readbacks matching the predicate
+    template <typename Pred>
+    void DiscardReadbacks(Pred&& pred);
+
     /// Attempt to find a reinterpretable surface in the cache and use it to copy for validation
     bool ValidateByReinterpretation(Surface& surface, SurfaceParams params,
                                     const SurfaceInterval& interval);
@@ -207,13 +231,34 @@ private:
     void UpdatePagesCachedCount(PAddr addr, u32 size, int delta);
 
 private:
+    struct Readback {
+        SurfaceId surface_id;
+        SurfaceInterval interval;
+        StagingData staging;
+        u64 tick;
+        u64 frame;
+        bool used;
+    };
+
+    /// Legacy hash of the texture last hashed at an address, along with the hash of its guest data
+    struct LegacyHash {
+        u32 size;
+        u32 width;
+        u32 height;
+        u32 stride;
+        PixelFormat pixel_format;
+        bool is_tiled;
+        u64 data_hash;
+        u64 hash;
+    };
+
     Memory::MemorySystem& memory;
     CustomTexManager& custom_tex_manager;
     Runtime& runtime;
     Pica::RegsInternal& regs;
     RendererBase& renderer;
     std::unordered_map<TextureCubeConfig, TextureCube> texture_cube_cache;
-    tsl::robin_pg_map<u64, std::vector<SurfaceId>, Common::IdentityHash<u64>> page_table;
+    SurfacePageTable page_table;
     std::unordered_map<FramebufferParams, FramebufferId> framebuffers;
     std::unordered_map<SamplerParams, SamplerId> samplers;
     std::list<std::pair<SurfaceId, u64>> sentenced;
@@ -228,6 +273,11 @@ private:
     Settings::TextureFilter filter;
     bool dump_textures;
     bool use_custom_textures;
+    std::unique_ptr<Common::ThreadWorker> decode_workers;
+    std::vector<u8> hash_scratch;
+    std::unordered_map<PAddr, LegacyHash> legacy_hashes;
+    std::vector<Readback> readbacks;
+    u32 readback_bytes{};
 };
 
 } // namespace VideoCore
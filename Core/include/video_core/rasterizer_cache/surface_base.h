@@ -4,14 +4,15 @@
 
 #pragma once
 
-#include <set>
+#include <optional>
+#include <vector>
+#include "common/interval_map.h"
 #include "video_core/rasterizer_cache/surface_params.h"
 #include "video_core/rasterizer_cache/utils.h"
 
 namespace VideoCore {
 
-// Simplified surface regions for libretro core
-using SurfaceRegions = std::set<PAddr>;
+using SurfaceRegions = Common::IntervalSet<PAddr>;
 
 struct Material;
 
@@ -22,6 +23,7 @@ enum class SurfaceFlagBits : u32 {
     Custom = 1 << 3,       ///< Surface texture has been replaced with a custom texture.
     ShadowMap = 1 << 4,    ///< Surface is used during shadow rendering.
     RenderTarget = 1 << 5, ///< Surface was a render target.
+    Readback = 1 << 6,     ///< Surface data was read back by the CPU.
 };
 DECLARE_ENUM_FLAG_OPERATORS(SurfaceFlagBits);
 
@@ -48,6 +50,12 @@ public:
     /// Returns true if the surface contains a custom material with a normal map.
     bool HasNormalMap() const noexcept;
 
+    /// Returns the hash of the guest data in interval if it was not invalidated since hashing.
+    std::optional<u64> GetCachedHash(SurfaceInterval interval, bool new_hash) const;
+
+    /// Remembers the hash of the guest data in interval until the interval is invalidated.
+    void CacheHash(SurfaceInterval interval, bool new_hash, u64 hash);
+
     bool Overlaps(PAddr overlap_addr, std::size_t overlap_size) const noexcept {
         const PAddr overlap_end = overlap_addr + static_cast<PAddr>(overlap_size);
         return addr < overlap_end && overlap_addr < end;
@@ -72,6 +80,9 @@ public:
 
     void MarkInvalid(SurfaceInterval interval) {
         invalid_regions.insert(interval);
+        std::erase_if(hash_cache, [interval](const HashEntry& entry) {
+            return entry.interval.intersects(interval);
+        });
         modification_tick++;
     }
 
@@ -84,6 +95,14 @@ private:
     /// Returns the fill buffer value starting from copy_addr
     std::array<u8, 4> MakeFillBuffer(PAddr copy_addr);
 
+    struct HashEntry {
+        SurfaceInterval interval;
+        bool new_hash;
+        u64 hash;
+    };
+
+    std::vector<HashEntry> hash_cache;
+
 public:
     SurfaceFlagBits flags{};
     const Material* material = nullptr;
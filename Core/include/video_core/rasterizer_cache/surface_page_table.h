@@ -0,0 +1,124 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <limits>
+#include <vector>
+#include "common/common_types.h"
+#include "video_core/rasterizer_cache/slot_id.h"
+
+namespace VideoCore {
+
+/**
+ * Direct indexed table from the pages of the PICA physical address space to the surfaces
+ * overlapping them. Each page stores a few surface ids inline, additional ones spill into chains
+ * of fixed size blocks taken from a shared pool, so registering and unregistering surfaces does
+ * not allocate in the common case.
+ */
+class SurfacePageTable {
+    static constexpr u32 INLINE_SURFACES = 4;
+    static constexpr u32 BLOCK_SURFACES = 8;
+    static constexpr u32 INVALID_BLOCK = std::numeric_limits<u32>::max();
+
+    struct Page {
+        std::array<SurfaceId, INLINE_SURFACES> surfaces{};
+        u32 count{};
+        u32 overflow{INVALID_BLOCK};
+    };
+
+    struct OverflowBlock {
+        std::array<SurfaceId, BLOCK_SURFACES> surfaces{};
+        u32 next{INVALID_BLOCK};
+    };
+
+public:
+    static constexpr u32 PAGE_BITS = 18;
+    static constexpr u64 NUM_PAGES = 1ULL << (32 - PAGE_BITS);
+
+    class Iterator {
+    public:
+        SurfaceId operator*() const {
+            return index < INLINE_SURFACES
+                       ? page->surfaces[index]
+                       : table->blocks[block].surfaces[(index - INLINE_SURFACES) % BLOCK_SURFACES];
+        }
+
+        Iterator& operator++() {
+            ++index;
+            if (index == INLINE_SURFACES) {
+                block = page->overflow;
+            } else if (index > INLINE_SURFACES &&
+                       (index - INLINE_SURFACES) % BLOCK_SURFACES == 0) {
+                block = table->blocks[block].next;
+            }
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const noexcept {
+            return index == other.index;
+        }
+
+    private:
+        friend class SurfacePageTable;
+
+        Iterator(const SurfacePageTable* table_, const Page* page_, u32 index_)
+            : table{table_}, page{page_}, index{index_} {}
+
+        const SurfacePageTable* table;
+        const Page* page;
+        u32 index;
+        u32 block{INVALID_BLOCK};
+    };
+
+    struct Range {
+        Iterator first;
+        Iterator last;
+
+        Iterator begin() const {
+            return first;
+        }
+
+        Iterator end() const {
+            return last;
+        }
+    };
+
+    SurfacePageTable();
+    ~SurfacePageTable();
+
+    /// Returns the surfaces registered in the page.
+    Range Surfaces(u64 page) const {
+        const Page& entry = page < NUM_PAGES ? pages[page] : EMPTY_PAGE;
+        return Range{Iterator{this, &entry, 0}, Iterator{this, &entry, entry.count}};
+    }
+
+    /// Returns the most recently stored surface of the page or an invalid id if it is empty.
+    SurfaceId Back(u64 page) const;
+
+    /// Adds the surface to the page.
+    void Insert(u64 page, SurfaceId surface_id);
+
+    /// Removes the surface from the page. Returns false if it was not registered there.
+    bool Erase(u64 page, SurfaceId surface_id);
+
+    /// Removes all surfaces from all pages.
+    void Clear();
+
+private:
+    /// Returns a reference to the storage of the index-th surface of the page.
+    SurfaceId& Slot(Page& page, u32 index);
+
+    /// Returns the overflow block holding the index-th surface of the page.
+    u32 BlockOf(const Page& page, u32 index) const;
+
+    static const Page EMPTY_PAGE;
+
+    std::vector<Page> pages;
+    std::vector<OverflowBlock> blocks;
+    u32 free_block{INVALID_BLOCK};
+};
+
+} // namespace VideoCore
@@ -4,14 +4,14 @@
 
 #pragma once
 
+#include "common/interval_map.h"
 #include "common/math_util.h"
 #include "video_core/custom_textures/custom_format.h"
 #include "video_core/rasterizer_cache/pixel_format.h"
 
 namespace VideoCore {
 
-// Simplified surface interval for libretro core
-using SurfaceInterval = std::pair<PAddr, PAddr>;
+using SurfaceInterval = Common::Interval<PAddr>;
 
 constexpr std::size_t MAX_PICA_LEVELS = 8;
 
@@ -9,6 +9,7 @@
 #include <span>
 #include "common/alignment.h"
 #include "common/color.h"
+#include "video_core/rasterizer_cache/morton_swizzle.h"
 #include "video_core/rasterizer_cache/pixel_format.h"
 #include "video_core/texture/etc1.h"
 #include "video_core/utils.h"
@@ -85,33 +86,33 @@ constexpr void DecodePixel4(u32 x, u32 y, const u8* source_tile, u8* dest_pixel)
 }
 
 template <PixelFormat format>
-constexpr void DecodePixelETC1(u32 x, u32 y, const u8* source_tile, u8* dest_pixel) {
+void DecodeTileETC1(u32 stride, std::span<u8> tile_buffer, std::span<u8> linear_buffer) {
     constexpr u32 subtile_width = 4;
     constexpr u32 subtile_height = 4;
     constexpr bool has_alpha = format == PixelFormat::ETC1A4;
     constexpr std::size_t subtile_size = has_alpha ? 16 : 8;
 
-    const u32 subtile_index = (x / subtile_width) + 2 * (y / subtile_height);
-    x %= subtile_width;
-    y %= subtile_height;
+    // ETC1 further subdivides each 8x8 tile into four 4x4 subtiles, decode them whole.
+    for (u32 subtile_index = 0; subtile_index < 4; subtile_index++) {
+        const u8* subtile_ptr = tile_buffer.data() + subtile_index * subtile_size;
 
-    const u8* subtile_ptr = source_tile + subtile_index * subtile_size;
+        u64 packed_alpha = Pica::Texture::ETC1_OPAQUE_ALPHA;
+        if constexpr (has_alpha) {
+            packed_alpha = MakeInt<u64_le>(subtile_ptr);
+            subtile_ptr += sizeof(u64);
+        }
 
-    u8 alpha = 255;
-    if constexpr (has_alpha) {
-        u64_le packed_alpha;
-        std::memcpy(&packed_alpha, subtile_ptr, sizeof(u64));
-        subtile_ptr += sizeof(u64);
+        const auto texels =
+            Pica::Texture::DecodeETC1Block(MakeInt<u64_le>(subtile_ptr), packed_alpha);
 
-        alpha = Common::Color::Convert4To8((packed_alpha >> (4 * (x * subtile_width + y))) & 0xF);
+        const u32 x = (subtile_index % 2) * subtile_width;
+        const u32 y = (subtile_index / 2) * subtile_height;
+        for (u32 row = 0; row < subtile_height; row++) {
+            const u32 linear_offset = ((7 - y - row) * stride + x) * 4;
+            std::memcpy(linear_buffer.data() + linear_offset, &texels[row * subtile_width],
+                        subtile_width * sizeof(Common::Vec4<u8>));
+        }
     }
-
-    const u64_le subtile_data = MakeInt<u64_le>(subtile_ptr);
-    const auto rgb = Pica::Texture::SampleETC1Subtile(subtile_data, x, y);
-
-    // Copy the uncompressed pixel to the destination
-    std::memcpy(dest_pixel, rgb.AsArray(), 3);
-    dest_pixel[3] = alpha;
 }
 
 template <PixelFormat format, bool converted>
@@ -203,6 +204,11 @@ constexpr void MortonCopyTile(u32 stride, std::span<u8> tile_buffer, std::span<u
     constexpr bool is_compressed = format == PixelFormat::ETC1 || format == PixelFormat::ETC1A4;
     constexpr bool is_4bit = format == PixelFormat::I4 || format == PixelFormat::A4;
 
+    if constexpr (morton_to_linear && is_compressed) {
+        DecodeTileETC1<format>(stride, tile_buffer, linear_buffer);
+        return;
+    }
+
     for (u32 y = 0; y < 8; y++) {
         for (u32 x = 0; x < 8; x++) {
             const auto tiled_pixel = tile_buffer.subspan(
@@ -210,9 +216,7 @@ constexpr void MortonCopyTile(u32 stride, std::span<u8> tile_buffer, std::span<u
             const auto linear_pixel = linear_buffer.subspan(
                 ((7 - y) * stride + x) * linear_bytes_per_pixel, linear_bytes_per_pixel);
             if constexpr (morton_to_linear) {
-                if constexpr (is_compressed) {
-                    DecodePixelETC1<format>(x, y, tile_buffer.data(), linear_pixel.data());
-                } else if constexpr (is_4bit) {
+                if constexpr (is_4bit) {
                     DecodePixel4<format>(x, y, tile_buffer.data(), linear_pixel.data());
                 } else {
                     DecodePixel<format, converted>(tiled_pixel.data(), linear_pixel.data());
@@ -252,10 +256,13 @@ constexpr void MortonCopyTile(u32 stride, std::span<u8> tile_buffer, std::span<u
  * not required to be aligned to any specific boundary which requires special care.
  * start_offset/end_offset are useful here as they tell us exactly where the data should be placed
  * in the linear_buffer.
+ *
+ * Whole tiles are converted by the vectorized kernels from GetMortonTileFunc when the host
+ * supports them, falling back to MortonCopyTile otherwise.
  */
 template <bool morton_to_linear, PixelFormat format, bool converted = false>
-static constexpr void MortonCopy(u32 width, u32 height, u32 start_offset, u32 end_offset,
-                                 std::span<u8> linear_buffer, std::span<u8> tiled_buffer) {
+static void MortonCopy(u32 width, u32 height, u32 start_offset, u32 end_offset,
+                       std::span<u8> linear_buffer, std::span<u8> tiled_buffer) {
     constexpr u32 bytes_per_pixel = GetFormatBpp(format) / 8;
     constexpr u32 aligned_bytes_per_pixel = converted ? 4 : GetFormatBytesPerPixel(format);
     constexpr u32 tile_size = GetFormatBpp(format) * 64 / 8;
@@ -278,6 +285,16 @@ static constexpr void MortonCopy(u32 width, u32 height, u32 start_offset, u32 en
     u32 linear_offset = ((height - 8 - y) * width + x) * aligned_bytes_per_pixel;
     u32 tiled_offset = 0;
 
+    static const MortonTileFunc simd_copy_tile =
+        GetMortonTileFunc(morton_to_linear, format, converted);
+    const auto copy_tile = [&](std::span<u8> tile_data, std::span<u8> linear_data) {
+        if (simd_copy_tile) {
+            simd_copy_tile(width, tile_data.data(), linear_data.data());
+        } else {
+            MortonCopyTile<morton_to_linear, format, converted>(width, tile_data, linear_data);
+        }
+    };
+
     const auto linear_next_tile = [&] {
         x = (x + 8) % width;
         linear_offset += 8 * aligned_bytes_per_pixel;
@@ -296,7 +313,7 @@ static constexpr void MortonCopy(u32 width, u32 height, u32 start_offset, u32 en
     if (start_offset < aligned_start_offset && !morton_to_linear) {
         std::array<u8, tile_size> tmp_buf;
         auto linear_data = linear_buffer.subspan(linear_offset, linear_tile_stride);
-        MortonCopyTile<morton_to_linear, format, converted>(width, tmp_buf, linear_data);
+        copy_tile(tmp_buf, linear_data);
 
         std::memcpy(tiled_buffer.data(), tmp_buf.data() + start_offset - aligned_down_start_offset,
                     std::min(aligned_start_offset, end_offset) - start_offset);
@@ -313,7 +330,7 @@ static constexpr void MortonCopy(u32 width, u32 height, u32 start_offset, u32 en
         while (tiled_offset < buffer_end) {
             auto linear_data = linear_buffer.subspan(linear_offset, linear_tile_stride);
             auto tiled_data = tiled_buffer.subspan(tiled_offset, tile_size);
-            MortonCopyTile<morton_to_linear, format, converted>(width, tiled_data, linear_data);
+            copy_tile(tiled_data, linear_data);
             tiled_offset += tile_size;
             linear_next_tile();
         }
@@ -324,7 +341,7 @@ static constexpr void MortonCopy(u32 width, u32 height, u32 start_offset, u32 en
     if (end_offset > std::max(aligned_start_offset, aligned_end_offset) && !morton_to_linear) {
         std::array<u8, tile_size> tmp_buf;
         auto linear_data = linear_buffer.subspan(linear_offset, linear_tile_stride);
-        MortonCopyTile<morton_to_linear, format, converted>(width, tmp_buf, linear_data);
+        copy_tile(tmp_buf, linear_data);
         std::memcpy(tiled_buffer.data() + tiled_offset, tmp_buf.data(),
                     end_offset - aligned_end_offset);
     }
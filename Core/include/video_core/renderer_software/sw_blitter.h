@@ -4,6 +4,10 @@
 
 #pragma once
 
+#include <array>
+#include <vector>
+#include "common/common_types.h"
+
 namespace Pica {
 struct DisplayTransferConfig;
 struct MemoryFillConfig;
@@ -33,6 +37,9 @@ public:
 private:
     Memory::MemorySystem& memory;
     VideoCore::RasterizerInterface* rasterizer;
+    std::array<std::vector<u32>, 2> input_rows;
+    std::vector<u32> output_row;
+    std::vector<u8> staging_row;
 };
 
 } // namespace SwRenderer
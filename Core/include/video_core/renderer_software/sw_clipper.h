@@ -0,0 +1,77 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/vector_math.h"
+#include "video_core/pica/output_vertex.h"
+
+namespace SwRenderer {
+
+using Pica::f24;
+
+struct Vertex : Pica::OutputVertex {
+    Vertex() = default;
+    Vertex(const OutputVertex& v) : OutputVertex(v) {}
+
+    /// Screen space position after perspective divide and viewport transform.
+    Common::Vec3<f24> screenpos;
+
+    /**
+     * Linear interpolation
+     * factor: 0=this, 1=vtx
+     * Note: This function cannot be called after perspective divide.
+     **/
+    void Lerp(f24 factor, const Vertex& vtx) {
+        pos = pos * factor + vtx.pos * (f24::One() - factor);
+        quat = quat * factor + vtx.quat * (f24::One() - factor);
+        color = color * factor + vtx.color * (f24::One() - factor);
+        tc0 = tc0 * factor + vtx.tc0 * (f24::One() - factor);
+        tc1 = tc1 * factor + vtx.tc1 * (f24::One() - factor);
+        tc0_w = tc0_w * factor + vtx.tc0_w * (f24::One() - factor);
+        view = view * factor + vtx.view * (f24::One() - factor);
+        tc2 = tc2 * factor + vtx.tc2 * (f24::One() - factor);
+    }
+
+    /**
+     * Linear interpolation
+     * factor: 0=v0, 1=v1
+     * Note: This function cannot be called after perspective divide.
+     **/
+    static Vertex Lerp(f24 factor, const Vertex& v0, const Vertex& v1) {
+        Vertex ret = v0;
+        ret.Lerp(factor, v1);
+        return ret;
+    }
+};
+
+/// Homogeneous clip-space half-space, a vertex is inside when dot(pos + bias, coeffs) >= 0.
+class ClippingEdge {
+public:
+    ClippingEdge(Common::Vec4<f24> coeffs,
+                 Common::Vec4<f24> bias = Common::Vec4<f24>(f24::Zero(), f24::Zero(), f24::Zero(),
+                                                            f24::Zero()))
+        : coeffs(coeffs), bias(bias) {}
+
+    bool IsInside(const Vertex& vertex) const {
+        return Common::Dot(vertex.pos + bias, coeffs) >= f24::Zero();
+    }
+
+    bool IsOutSide(const Vertex& vertex) const {
+        return !IsInside(vertex);
+    }
+
+    Vertex GetIntersection(const Vertex& v0, const Vertex& v1) const {
+        const f24 dp = Common::Dot(v0.pos + bias, coeffs);
+        const f24 dp_prev = Common::Dot(v1.pos + bias, coeffs);
+        const f24 factor = dp_prev / (dp_prev - dp);
+        return Vertex::Lerp(factor, v0, v1);
+    }
+
+private:
+    Common::Vec4<f24> coeffs;
+    Common::Vec4<f24> bias;
+};
+
+} // namespace SwRenderer
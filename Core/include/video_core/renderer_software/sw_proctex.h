@@ -0,0 +1,16 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/vector_math.h"
+#include "video_core/pica/pica_core.h"
+
+namespace SwRenderer {
+
+/// Generates procedural texture color for the given coordinates
+Common::Vec4<u8> ProcTex(float u, float v, const Pica::TexturingRegs& regs,
+                         const Pica::PicaCore::ProcTex& state);
+
+} // namespace SwRenderer
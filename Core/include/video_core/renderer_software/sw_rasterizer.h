@@ -0,0 +1,115 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <span>
+#include <vector>
+#include "common/math_util.h"
+#include "common/thread_worker.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_software/sw_clipper.h"
+#include "video_core/renderer_software/sw_framebuffer.h"
+#include "video_core/texture/texture_decode.h"
+
+namespace Pica {
+class PicaCore;
+struct RegsInternal;
+} // namespace Pica
+
+namespace SwRenderer {
+
+/**
+ * Tile based software rasterizer.
+ *
+ * Triangles submitted through AddTriangle are clipped and set up on the emulation thread, then
+ * binned into fixed size screen tiles once the batch ends. Every tile references its triangles
+ * in submission order and owns a disjoint pixel region, so tiles are shaded in parallel on the
+ * worker pool without any synchronization on the framebuffer while still preserving the ordering
+ * guarantees of the hardware.
+ */
+class RasterizerSoftware : public VideoCore::RasterizerInterface {
+public:
+    explicit RasterizerSoftware(Memory::MemorySystem& memory, Pica::PicaCore& pica);
+    ~RasterizerSoftware() override;
+
+    void AddTriangle(const Pica::OutputVertex& v0, const Pica::OutputVertex& v1,
+                     const Pica::OutputVertex& v2) override;
+    void DrawTriangles() override;
+    void FlushAll() override {}
+    void FlushRegion(PAddr addr, u32 size) override {}
+    void InvalidateRegion(PAddr addr, u32 size) override {}
+    void FlushAndInvalidateRegion(PAddr addr, u32 size) override {}
+    void ClearAll(bool flush) override {}
+
+private:
+    /// Edge length in pixels of the screen tiles distributed to the workers.
+    static constexpr u32 TILE_SIZE = 32;
+
+    /// Fully set up triangle ready for rasterization, positions are in 12.4 fixed point.
+    struct Triangle {
+        std::array<Vertex, 3> vtx;
+        std::array<Common::Vec2<s32>, 3> pos;
+        std::array<s32, 3> bias;
+        Common::Rectangle<s32> bounds; ///< Inclusive-exclusive pixel bounds
+    };
+
+    /// Per tile copy of the texture unit state that is invariant during a batch.
+    struct TextureUnits {
+        std::array<bool, 3> enabled{};
+        std::array<Pica::TexturingRegs::TextureConfig, 3> config{};
+        std::array<Pica::Texture::TextureInfo, 3> info{};
+    };
+
+    /// Converts the vertex to screen space coordinates.
+    void MakeScreenCoords(Vertex& vtx);
+
+    /// Culls and sets up the triangle, appending it to the current batch.
+    void SetupTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2);
+
+    /// Rasterizes the provided triangles restricted to the tile.
+    void RasterizeTile(std::span<const u32> triangle_ids,
+                       const Common::Rectangle<s32>& tile) const;
+
+    /// Rasterizes a single triangle restricted to the tile.
+    void RasterizeTriangle(const Triangle& triangle, const Common::Rectangle<s32>& tile,
+                           const TextureUnits& units,
+                           std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages) const;
+
+    /// Computes the sampled texture colors of all units for the provided texture coordinates.
+    std::array<Common::Vec4<u8>, 4> TextureColor(std::span<const Common::Vec2<f24>, 3> uv,
+                                                 const TextureUnits& units, f24 tc0_w) const;
+
+    /// Executes the texture environment stages and returns the combined color.
+    Common::Vec4<u8> WriteTevConfig(
+        std::span<const Common::Vec4<u8>, 4> texture_color,
+        std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages,
+        Common::Vec4<u8> primary_color, Common::Vec4<u8> primary_fragment_color,
+        Common::Vec4<u8> secondary_fragment_color) const;
+
+    /// Blends fog to the combiner output if enabled.
+    void WriteFog(float depth, Common::Vec4<u8>& combiner_output) const;
+
+    /// Performs the alpha test. Returns false if the test failed.
+    bool DoAlphaTest(u8 alpha) const;
+
+    /// Performs the depth-stencil test. Returns false if the test failed.
+    bool DoDepthStencilTest(u32 x, u32 y, float depth) const;
+
+    /// Returns the final pixel color with blending or logic ops applied.
+    Common::Vec4<u8> PixelColor(u32 x, u32 y, const Common::Vec4<u8>& combiner_output) const;
+
+private:
+    Memory::MemorySystem& memory;
+    Pica::PicaCore& pica;
+    Pica::RegsInternal& regs;
+    std::size_t num_sw_threads;
+    Common::ThreadWorker sw_workers;
+    Framebuffer fb;
+    std::vector<Triangle> triangles;
+    std::vector<std::vector<u32>> tile_bins;
+};
+
+} // namespace SwRenderer
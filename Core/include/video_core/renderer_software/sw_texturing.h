@@ -0,0 +1,28 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <span>
+#include "common/common_types.h"
+#include "common/vector_math.h"
+#include "video_core/pica/regs_texturing.h"
+
+namespace SwRenderer {
+
+using TevStageConfig = Pica::TexturingRegs::TevStageConfig;
+
+int GetWrappedTexCoord(Pica::TexturingRegs::TextureConfig::WrapMode mode, s32 val, u32 size);
+
+Common::Vec3<u8> GetColorModifier(TevStageConfig::ColorModifier factor,
+                                  const Common::Vec4<u8>& values);
+
+u8 GetAlphaModifier(TevStageConfig::AlphaModifier factor, const Common::Vec4<u8>& values);
+
+Common::Vec3<u8> ColorCombine(TevStageConfig::Operation op,
+                              std::span<const Common::Vec3<u8>, 3> input);
+
+u8 AlphaCombine(TevStageConfig::Operation op, const std::array<u8, 3>& input);
+
+} // namespace SwRenderer
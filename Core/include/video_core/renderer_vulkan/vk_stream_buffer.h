@@ -40,6 +40,9 @@ public:
     /// Ensures that "size" bytes of memory are available to the GPU, potentially recording a copy.
     void Commit(u32 size);
 
+    /// Makes GPU writes to a previously committed download region visible to the host.
+    void Invalidate(u32 region_offset, u32 size);
+
     vk::Buffer Handle() const noexcept {
         return buffer;
     }
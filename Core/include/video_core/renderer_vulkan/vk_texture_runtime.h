@@ -63,6 +63,12 @@ public:
     /// Submits and waits for current GPU work.
     void Finish();
 
+    /// Submits current GPU work without waiting for it.
+    void Flush();
+
+    /// Waits for an asynchronous download to complete and makes staging visible to the host.
+    void WaitDownload(u64 tick, const VideoCore::StagingData& staging);
+
     /// Maps an internal staging buffer of the provided size for pixel uploads/downloads
     VideoCore::StagingData FindStaging(u32 size, bool upload);
 
@@ -156,6 +162,11 @@ public:
     void Download(const VideoCore::BufferTextureCopy& download,
                   const VideoCore::StagingData& staging);
 
+    /// Records a download to staging without waiting for it. Returns the tick that must be
+    /// waited with TextureRuntime::WaitDownload before staging is read.
+    u64 DownloadAsync(const VideoCore::BufferTextureCopy& download,
+                      const VideoCore::StagingData& staging);
+
     /// Scales up the surface to match the new resolution scale.
     void ScaleUp(u32 new_scale);
 
@@ -169,6 +180,9 @@ public:
     vk::PipelineStageFlags PipelineStageFlags() const noexcept;
 
 private:
+    /// Records the commands copying a rectangle region of the surface texture to staging
+    void RecordDownload(const VideoCore::BufferTextureCopy& download);
+
     /// Performs blit between the scaled/unscaled images
     void BlitScale(const VideoCore::TextureBlit& blit, bool up_scale);
 
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <memory>
+#include <span>
 #include "common/common_types.h"
 
 namespace Pica {
@@ -29,6 +30,22 @@ public:
      * @param state Shader unit state, must be setup with input data before each shader invocation.
      */
     virtual void Run(const ShaderSetup& setup, ShaderUnit& state) const = 0;
+
+    /**
+     * Runs the currently setup shader on a batch of shader units. Engines override this to
+     * shade the units of the batch together instead of one after another.
+     *
+     * @param setup Shader engine state, must be setup with SetupBatch on each shader change.
+     * @param states Shader unit states, each must be setup with input data before invocation.
+     */
+    virtual void RunBatch(const ShaderSetup& setup, std::span<ShaderUnit> states) const;
+
+    /**
+     * Switches any persistent compilation state of the engine to the provided title.
+     *
+     * @param title_id Program ID of the title that is about to submit shaders.
+     */
+    virtual void SwitchDiskCache([[maybe_unused]] u64 title_id) {}
 };
 
 std::unique_ptr<ShaderEngine> CreateEngine(bool use_jit);
@@ -7,10 +7,17 @@
 #include "common/arch.h"
 #if CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
 
+#include <atomic>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 #include "common/common_types.h"
+#include "common/thread_worker.h"
 #include "video_core/shader/shader.h"
+#include "video_core/shader/shader_interpreter.h"
+#include "video_core/shader/shader_jit_disk_cache.h"
 
 namespace Pica::Shader {
 
@@ -18,14 +25,65 @@ class JitShader;
 
 class JitEngine final : public ShaderEngine {
 public:
+    struct CacheStats {
+        u64 hits;
+        u64 misses;
+        u64 evictions;
+        std::size_t code_size;
+        std::size_t num_shaders;
+    };
+
     JitEngine();
     ~JitEngine() override;
 
     void SetupBatch(ShaderSetup& setup, u32 entry_point) override;
     void Run(const ShaderSetup& setup, ShaderUnit& state) const override;
+    void RunBatch(const ShaderSetup& setup, std::span<ShaderUnit> states) const override;
+    void SwitchDiskCache(u64 title_id) override;
+
+    /// Returns the accumulated cache counters along with the current memory usage.
+    [[nodiscard]] CacheStats GetCacheStats() const noexcept;
+
+    /// Resets the hit, miss and eviction counters.
+    void ResetCacheStats() noexcept;
 
 private:
-    std::unordered_map<u64, std::unique_ptr<JitShader>> cache;
+    struct CacheEntry {
+        std::unique_ptr<JitShader> shader;
+        std::list<u64>::iterator lru_it;
+    };
+
+    /// Returns the configured cache budget in bytes.
+    static std::size_t GetCacheBudget();
+
+    /// Frees least recently used shaders, then shaders compiled ahead of use, until the cache
+    /// fits the configured budget.
+    void EvictShaders();
+
+    /**
+     * Queues compilation of the program on the background worker.
+     * @param preload Whether the program comes from the disk cache rather than a cache miss.
+     * Preloaded programs are skipped once the shaders would exceed the cache budget.
+     */
+    void QueueCompile(std::unique_ptr<JitDiskCache::Entry> entry, bool preload);
+
+    /// Removes and returns the shader compiled in the background for the key, if any.
+    std::unique_ptr<JitShader> TakePrecompiled(u64 cache_key);
+
+    std::unordered_map<u64, CacheEntry> cache;
+    std::list<u64> lru;
+    std::unordered_map<const ShaderSetup*, u64> bound_keys;
+    std::atomic<std::size_t> code_size{};
+    CacheStats stats{};
+    InterpreterEngine interpreter;
+    std::unordered_set<u64> pending;
+    JitDiskCache disk_cache;
+    u64 current_title_id{};
+    std::mutex precompiled_mutex;
+    std::unordered_map<u64, std::unique_ptr<JitShader>> precompiled;
+    std::size_t precompiled_size{};
+    std::atomic_bool stop_precompile{};
+    Common::ThreadWorker precompile_worker;
 };
 
 } // namespace Pica::Shader
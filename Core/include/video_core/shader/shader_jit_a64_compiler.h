@@ -47,6 +47,11 @@ public:
     void Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code,
                  const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data);
 
+    /// Returns the size of the executable memory held by the shader.
+    std::size_t GetCodeSize() const {
+        return code_size;
+    }
+
     void Compile_ADD(Instruction instr);
     void Compile_DP3(Instruction instr);
     void Compile_DP4(Instruction instr);
@@ -80,6 +85,7 @@ public:
 private:
     std::vector<u32> code_vec;
     std::unique_ptr<oaknut::CodeBlock> code_mem;
+    std::size_t code_size{};
 
     void Compile_Block(u32 end);
     void Compile_NextInstr();
@@ -0,0 +1,45 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <unordered_set>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "video_core/pica/shader_setup.h"
+
+namespace Pica::Shader {
+
+/**
+ * Per-title record of the shader programs compiled by the JIT engine.
+ *
+ * The emitted host code references helper routines and constants by absolute address, so the
+ * cache stores the PICA program code and swizzle data of every compiled shader instead. These
+ * are recompiled in the background when a title boots, before the application requests them.
+ */
+class JitDiskCache {
+public:
+    struct Entry {
+        u64 key;
+        ProgramCode program_code;
+        SwizzleData swizzle_data;
+    };
+
+    JitDiskCache();
+    ~JitDiskCache();
+
+    /// Opens the cache file of the title and returns the valid entries stored in it.
+    std::vector<std::unique_ptr<Entry>> Open(u64 title_id);
+
+    /// Appends a newly compiled program to the currently open cache file.
+    void Append(u64 key, const ProgramCode& program_code, const SwizzleData& swizzle_data);
+
+private:
+    FileUtil::IOFile file;
+    std::unordered_set<u64> stored_keys;
+};
+
+} // namespace Pica::Shader
@@ -45,6 +45,12 @@ public:
     void Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code,
                  const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data);
 
+    /// Returns the size of the executable memory held by the shader.
+    std::size_t GetCodeSize() const {
+        // The code buffer is reserved up front with the maximum shader size.
+        return MAX_SHADER_SIZE;
+    }
+
     void Compile_ADD(Instruction instr);
     void Compile_DP3(Instruction instr);
     void Compile_DP4(Instruction instr);
@@ -4,11 +4,25 @@
 
 #pragma once
 
+#include <array>
 #include "common/common_types.h"
 #include "common/vector_math.h"
 
 namespace Pica::Texture {
 
+/// Packed alpha of an ETC1 block without an alpha channel, every texel decodes to 255.
+constexpr u64 ETC1_OPAQUE_ALPHA = ~0ULL;
+
+/// Texels of a 4x4 ETC1 block, texel (x, y) is stored at index y * 4 + x.
+using ETC1Block = std::array<Common::Vec4<u8>, 16>;
+
 Common::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y);
 
+/**
+ * Decodes all the texels of a 4x4 ETC1 block at once.
+ * @param value The color data of the block
+ * @param alpha The 4 bit alpha values that precede the color data in ETC1A4 blocks
+ */
+ETC1Block DecodeETC1Block(u64 value, u64 alpha = ETC1_OPAQUE_ALPHA);
+
 } // namespace Pica::Texture
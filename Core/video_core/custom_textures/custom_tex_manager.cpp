@@ -2,8 +2,12 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
+#include <span>
 #include <json.hpp>
 #include "common/file_util.h"
+#include "common/hash.h"
 #include "common/literals.h"
 #include "common/memory_detect.h"
 #include "common/microprofile.h"
@@ -27,8 +31,21 @@ MICROPROFILE_DEFINE(CustomTexManager_TickFrame, "CustomTexManager", "TickFrame",
 
 constexpr std::size_t MAX_UPLOADS_PER_TICK = 8;
 
+// Prefetched materials recorded this far before the latest request were skipped by the title.
+constexpr std::size_t PREFETCH_SKIP_DISTANCE = 64;
+
 using namespace Common::Literals;
 
+/// Returns the amount of memory custom textures may occupy when preloaded.
+u64 GetTextureMemoryBudget() {
+    const u64 sys_mem = Common::GetMemInfo().total_physical_memory;
+    const u64 recommended_min_mem = 2_GiB;
+
+    // keep 2GiB memory for system stability if system RAM is 4GiB+ - use half of memory in other
+    // cases
+    return (sys_mem / 2 < recommended_min_mem) ? (sys_mem / 2) : (sys_mem - recommended_min_mem);
+}
+
 bool IsPow2(u32 value) {
     return value != 0 && (value & (value - 1)) == 0;
 }
@@ -52,13 +69,118 @@ MapType MakeMapType(std::string_view ext) {
     return MapType::Color;
 }
 
+constexpr u32 INDEX_MAGIC = 0x58495443; // "CTIX"
+constexpr u32 INDEX_VERSION = 1;
+
+struct IndexHeader {
+    u32 magic;
+    u32 version;
+    u64 config_time;
+    u32 num_directories;
+    u32 num_textures;
+};
+
+struct IndexDirectory {
+    u64 modification_time;
+    u32 path_size;
+};
+
+struct IndexTexture {
+    CustomFileFormat file_format;
+    MapType type;
+    u32 num_hashes;
+    u32 path_size;
+};
+
+std::string GetLoadPath(u64 title_id) {
+    return fmt::format("{}textures/{:016X}/", GetUserPath(FileUtil::UserPath::LoadDir), title_id);
+}
+
+std::string GetAccessLogPath(u64 title_id) {
+    return fmt::format("{}custom_textures{}{:016X}_access.bin",
+                       FileUtil::GetUserPath(FileUtil::UserPath::CacheDir), DIR_SEP, title_id);
+}
+
+std::string GetTranscodedPath(const std::string& path) {
+    return fmt::format("{}custom_textures{}transcoded{}{:016X}.bin",
+                       FileUtil::GetUserPath(FileUtil::UserPath::CacheDir), DIR_SEP, DIR_SEP,
+                       Common::ComputeHash64(path.data(), path.size()));
+}
+
+std::string GetIndexPath(u64 title_id) {
+    return fmt::format("{}custom_textures{}{:016X}.bin",
+                       FileUtil::GetUserPath(FileUtil::UserPath::CacheDir), DIR_SEP, title_id);
+}
+
+void GetNestedDirectories(const FileUtil::FSTEntry& directory,
+                          std::vector<std::string>& output) {
+    for (const auto& entry : directory.children) {
+        if (entry.isDirectory) {
+            output.push_back(entry.physicalName);
+            GetNestedDirectories(entry, output);
+        }
+    }
+}
+
+/// Reads the index file contents in order, failing once the data runs out.
+class IndexReader {
+public:
+    explicit IndexReader(std::span<const u8> data_) : data{data_} {}
+
+    template <typename T>
+    bool Read(T* values, std::size_t count = 1) {
+        if (count > (data.size() - offset) / sizeof(T)) {
+            return false;
+        }
+        std::memcpy(values, data.data() + offset, sizeof(T) * count);
+        offset += sizeof(T) * count;
+        return true;
+    }
+
+    /// Reads count values into the container, checking the size before allocating.
+    template <typename Container>
+    bool ReadRange(Container& container, std::size_t count) {
+        if (count > (data.size() - offset) / sizeof(typename Container::value_type)) {
+            return false;
+        }
+        container.resize(count);
+        return Read(container.data(), count);
+    }
+
+private:
+    std::span<const u8> data;
+    std::size_t offset{};
+};
+
+/// The index is validated by modification times, which Android storage paths do not expose.
+constexpr bool HasModificationTimes() {
+#ifdef ANDROID
+    return false;
+#else
+    return true;
+#endif
+}
+
+template <typename T>
+void AppendIndex(std::vector<u8>& data, const T* values, std::size_t count = 1) {
+    const auto bytes = reinterpret_cast<const u8*>(values);
+    data.insert(data.end(), bytes, bytes + sizeof(T) * count);
+}
+
 } // Anonymous namespace
 
 CustomTexManager::CustomTexManager(Core::System& system_)
     : system{system_}, image_interface{*system.GetImageInterface()},
-      async_custom_loading{Settings::values.async_custom_loading.GetValue()} {}
+      async_custom_loading{Settings::values.async_custom_loading.GetValue()},
+      cache_custom_textures{Settings::values.cache_custom_textures.GetValue()} {
+    prefetch_budget = Settings::values.texture_prefetch_size.GetValue() * 1_MiB;
+}
 
-CustomTexManager::~CustomTexManager() = default;
+CustomTexManager::~CustomTexManager() {
+    StopPrefetch();
+    prefetch_worker.reset();
+    WriteAccessLog();
+}
 
 void CustomTexManager::TickFrame() {
     MICROPROFILE_SCOPE(CustomTexManager_TickFrame);
@@ -94,7 +216,24 @@ void CustomTexManager::FindCustomTextures() {
     }
 
     const u64 title_id = system.Kernel().GetCurrentProcess()->codeset->program_id;
-    const auto textures = GetTextures(title_id);
+
+    // Large packs take a long time to scan, so reuse the parsed textures of the last boot when
+    // none of the pack directories changed. The texture mappings of the pack config are part of
+    // the index, only its options need to be read again.
+    if (HasModificationTimes() && LoadIndex(title_id)) {
+        if (!ReadConfig(title_id, true)) {
+            use_new_hash = false;
+            skip_mipmap = true;
+        }
+        LOG_INFO(Render, "Loaded {} custom textures from the pack index", custom_textures.size());
+        textures_loaded = true;
+        LoadAccessLog(title_id);
+        StartPrefetch();
+        return;
+    }
+
+    std::vector<std::string> directories;
+    const auto textures = GetTextures(title_id, directories);
     if (!ReadConfig(title_id)) {
         use_new_hash = false;
         skip_mipmap = true;
@@ -105,21 +244,126 @@ void CustomTexManager::FindCustomTextures() {
         if (file.isDirectory) {
             continue;
         }
-        custom_textures.push_back(std::make_unique<CustomTexture>(image_interface));
-        CustomTexture* const texture{custom_textures.back().get()};
-        if (!ParseFilename(file, texture)) {
+        auto texture = std::make_unique<CustomTexture>(image_interface);
+        if (!ParseFilename(file, texture.get())) {
             continue;
         }
-        for (const u64 hash : texture->hashes) {
-            auto& material = material_map[hash];
-            if (!material) {
-                material = std::make_unique<Material>();
-            }
-            material->hash = hash;
-            material->AddMapTexture(texture);
-        }
+        AddTexture(std::move(texture));
+    }
+    if (HasModificationTimes()) {
+        WriteIndex(title_id, directories);
     }
     textures_loaded = true;
+    LoadAccessLog(title_id);
+    StartPrefetch();
+}
+
+void CustomTexManager::AddTexture(std::unique_ptr<CustomTexture>&& texture) {
+    if (cache_custom_textures && texture->file_format == CustomFileFormat::PNG) {
+        texture->cache_path = GetTranscodedPath(texture->path);
+    }
+    for (const u64 hash : texture->hashes) {
+        auto& material = material_map[hash];
+        if (!material) {
+            material = std::make_unique<Material>();
+        }
+        material->hash = hash;
+        material->AddMapTexture(texture.get());
+    }
+    custom_textures.push_back(std::move(texture));
+}
+
+bool CustomTexManager::LoadIndex(u64 title_id) {
+    FileUtil::IOFile file{GetIndexPath(title_id), "rb"};
+    if (!file.IsOpen()) {
+        return false;
+    }
+    std::vector<u8> data(file.GetSize());
+    if (file.ReadBytes(data.data(), data.size()) != data.size()) {
+        return false;
+    }
+
+    IndexReader reader{data};
+    IndexHeader header;
+    if (!reader.Read(&header) || header.magic != INDEX_MAGIC || header.version != INDEX_VERSION ||
+        header.config_time !=
+            FileUtil::GetModificationTime(GetLoadPath(title_id) + "pack.json")) {
+        return false;
+    }
+
+    // Adding, removing or renaming a file updates the modification time of its directory.
+    std::string path;
+    for (u32 i = 0; i < header.num_directories; i++) {
+        IndexDirectory directory;
+        if (!reader.Read(&directory) || !reader.ReadRange(path, directory.path_size) ||
+            directory.modification_time == 0 ||
+            directory.modification_time != FileUtil::GetModificationTime(path)) {
+            return false;
+        }
+    }
+
+    std::vector<std::unique_ptr<CustomTexture>> textures;
+    textures.reserve(header.num_textures);
+    for (u32 i = 0; i < header.num_textures; i++) {
+        IndexTexture entry;
+        auto texture = std::make_unique<CustomTexture>(image_interface);
+        if (!reader.Read(&entry) || !reader.ReadRange(texture->path, entry.path_size)) {
+            return false;
+        }
+        if (!reader.ReadRange(texture->hashes, entry.num_hashes)) {
+            return false;
+        }
+        texture->file_format = entry.file_format;
+        texture->type = entry.type;
+        textures.push_back(std::move(texture));
+    }
+
+    for (auto& texture : textures) {
+        AddTexture(std::move(texture));
+    }
+    return true;
+}
+
+void CustomTexManager::WriteIndex(u64 title_id, const std::vector<std::string>& directories) {
+    const IndexHeader header = {
+        .magic = INDEX_MAGIC,
+        .version = INDEX_VERSION,
+        .config_time = FileUtil::GetModificationTime(GetLoadPath(title_id) + "pack.json"),
+        .num_directories = static_cast<u32>(directories.size()),
+        .num_textures = static_cast<u32>(custom_textures.size()),
+    };
+
+    std::vector<u8> data;
+    AppendIndex(data, &header);
+    for (const std::string& path : directories) {
+        // Value-initialize so the tail padding written to the file is zeroed.
+        IndexDirectory directory{};
+        directory.modification_time = FileUtil::GetModificationTime(path);
+        directory.path_size = static_cast<u32>(path.size());
+        AppendIndex(data, &directory);
+        AppendIndex(data, path.data(), path.size());
+    }
+    for (const auto& texture : custom_textures) {
+        const IndexTexture entry = {
+            .file_format = texture->file_format,
+            .type = texture->type,
+            .num_hashes = static_cast<u32>(texture->hashes.size()),
+            .path_size = static_cast<u32>(texture->path.size()),
+        };
+        AppendIndex(data, &entry);
+        AppendIndex(data, texture->path.data(), texture->path.size());
+        AppendIndex(data, texture->hashes.data(), texture->hashes.size());
+    }
+
+    const std::string index_path = GetIndexPath(title_id);
+    if (!FileUtil::CreateFullPath(index_path)) {
+        LOG_ERROR(Render, "Unable to create {}", index_path);
+        return;
+    }
+    FileUtil::IOFile file{index_path, "wb"};
+    if (!file.IsOpen() || file.WriteBytes(data.data(), data.size()) != data.size()) {
+        LOG_ERROR(Render, "Unable to write custom texture index {}", index_path);
+    }
 }
 
 bool CustomTexManager::ParseFilename(const FileUtil::FSTEntry& file, CustomTexture* texture) {
@@ -208,13 +452,10 @@ void CustomTexManager::PreloadTextures(const std::atomic_bool& stop_run,
                                        const VideoCore::DiskResourceLoadCallback& callback) {
     u64 size_sum = 0;
     std::size_t preloaded = 0;
-    const u64 sys_mem = Common::GetMemInfo().total_physical_memory;
-    const u64 recommended_min_mem = 2_GiB;
+    const u64 max_mem = GetTextureMemoryBudget();
 
-    // keep 2GiB memory for system stability if system RAM is 4GiB+ - use half of memory in other
-    // cases
-    const u64 max_mem =
-        (sys_mem / 2 < recommended_min_mem) ? (sys_mem / 2) : (sys_mem - recommended_min_mem);
+    // Everything is loaded now, so the prefetched materials are kept as well.
+    StopPrefetch();
 
     workers->QueueWork([&]() {
         for (auto& [hash, material] : material_map) {
@@ -225,8 +466,10 @@ void CustomTexManager::PreloadTextures(const std::atomic_bool& stop_run,
             if (stop_run) {
                 return;
             }
-            material->LoadFromDisk(flip_png_files);
-            size_sum += material->size;
+            if (material->TryClaim()) {
+                material->LoadFromDisk(flip_png_files);
+                size_sum += material->size;
+            }
             if (callback) {
                 callback(VideoCore::LoadCallbackStage::Preload, preloaded, custom_textures.size());
             }
@@ -292,16 +535,27 @@ Material* CustomTexManager::GetMaterial(u64 data_hash) {
         LOG_WARNING(Render, "Unable to find replacement for surface with hash {:016X}", data_hash);
         return nullptr;
     }
+    if (logged_hashes.insert(data_hash).second) {
+        access_log.push_back(data_hash);
+    }
     return it->second.get();
 }
 
 bool CustomTexManager::Decode(Material* material, std::function<bool()>&& upload) {
+    MarkRequested(material);
+
+    // The prefetcher may be loading the material already, claim it before loading.
+    const bool claimed = material->TryClaim();
     if (!async_custom_loading) {
-        material->LoadFromDisk(flip_png_files);
+        if (claimed) {
+            material->LoadFromDisk(flip_png_files);
+        }
+        while (material->IsPending()) {
+            std::this_thread::yield();
+        }
         return upload();
     }
-    if (material->IsUnloaded()) {
-        material->state = DecodeState::Pending;
+    if (claimed) {
         workers->QueueWork([material, this] { material->LoadFromDisk(flip_png_files); });
     }
     async_uploads.push_back({
@@ -370,9 +624,9 @@ bool CustomTexManager::ReadConfig(u64 title_id, bool options_only) {
     return true;
 }
 
-std::vector<FileUtil::FSTEntry> CustomTexManager::GetTextures(u64 title_id) {
-    const std::string load_path =
-        fmt::format("{}textures/{:016X}/", GetUserPath(FileUtil::UserPath::LoadDir), title_id);
+std::vector<FileUtil::FSTEntry> CustomTexManager::GetTextures(
+    u64 title_id, std::vector<std::string>& directories) {
+    const std::string load_path = GetLoadPath(title_id);
     if (!FileUtil::Exists(load_path)) {
         FileUtil::CreateFullPath(load_path);
     }
@@ -381,9 +635,144 @@ std::vector<FileUtil::FSTEntry> CustomTexManager::GetTextures(u64 title_id) {
     std::vector<FileUtil::FSTEntry> textures;
     FileUtil::ScanDirectoryTree(load_path, texture_dir, 64);
     FileUtil::GetAllFilesFromNestedEntries(texture_dir, textures);
+
+    directories.push_back(load_path);
+    GetNestedDirectories(texture_dir, directories);
     return textures;
 }
 
+void CustomTexManager::LoadAccessLog(u64 title_id) {
+    log_title_id = title_id;
+    FileUtil::IOFile file{GetAccessLogPath(title_id), "rb"};
+    if (!file.IsOpen()) {
+        return;
+    }
+    std::vector<u64> hashes(file.GetSize() / sizeof(u64));
+    if (file.ReadArray(hashes.data(), hashes.size()) != hashes.size()) {
+        return;
+    }
+    for (const u64 hash : hashes) {
+        if (logged_hashes.insert(hash).second) {
+            access_log.push_back(hash);
+        }
+    }
+    saved_log_size = access_log.size();
+}
+
+void CustomTexManager::WriteAccessLog() {
+    if (access_log.size() == saved_log_size) {
+        return;
+    }
+    const std::string log_path = GetAccessLogPath(log_title_id);
+    if (!FileUtil::CreateFullPath(log_path)) {
+        LOG_ERROR(Render, "Unable to create {}", log_path);
+        return;
+    }
+    FileUtil::IOFile file{log_path, "wb"};
+    if (file.WriteArray(access_log.data(), access_log.size()) != access_log.size()) {
+        LOG_ERROR(Render, "Unable to write custom texture access log {}", log_path);
+        return;
+    }
+    saved_log_size = access_log.size();
+}
+
+void CustomTexManager::StartPrefetch() {
+    if (prefetch_budget == 0) {
+        return;
+    }
+    std::vector<Material*> materials;
+    materials.reserve(access_log.size());
+    for (const u64 hash : access_log) {
+        const auto it = material_map.find(hash);
+        if (it != material_map.end()) {
+            prefetch_order.emplace(it->second.get(), materials.size());
+            materials.push_back(it->second.get());
+        }
+    }
+    if (materials.empty()) {
+        return;
+    }
+
+    // Prefetching runs on its own thread so requests of the rasterizer never queue behind it.
+    if (!prefetch_worker) {
+        prefetch_worker = std::make_unique<Common::ThreadWorker>(1, "Custom texture prefetch");
+    }
+    LOG_INFO(Render, "Prefetching {} custom textures in recorded access order", materials.size());
+    prefetch_worker->QueueWork([this, materials = std::move(materials)] {
+        for (std::size_t order = 0; order < materials.size(); order++) {
+            Material* const material = materials[order];
+            {
+                // Wait for the title to request prefetched materials when the budget is used up.
+                std::unique_lock lock{prefetch_mutex};
+                prefetch_cv.wait(
+                    lock, [this] { return stop_prefetch || prefetched_size < prefetch_budget; });
+                if (stop_prefetch) {
+                    return;
+                }
+                if (order + PREFETCH_SKIP_DISTANCE < requested_order || !material->TryClaim()) {
+                    continue;
+                }
+                prefetched.push_back({material, order, 0});
+            }
+            material->LoadFromDisk(flip_png_files);
+
+            // The material is only charged when it wasn't requested while loading.
+            std::scoped_lock lock{prefetch_mutex};
+            const auto it = std::find_if(prefetched.rbegin(), prefetched.rend(),
+                                         [material](const PrefetchedMaterial& entry) {
+                                             return entry.material == material;
+                                         });
+            if (it != prefetched.rend()) {
+                it->size = material->size;
+                prefetched_size += material->size;
+            }
+        }
+    });
+}
+
+void CustomTexManager::StopPrefetch() {
+    {
+        std::scoped_lock lock{prefetch_mutex};
+        stop_prefetch = true;
+    }
+    prefetch_cv.notify_all();
+    if (prefetch_worker) {
+        prefetch_worker->WaitForRequests();
+    }
+    std::scoped_lock lock{prefetch_mutex};
+    prefetched.clear();
+    prefetched_size = 0;
+}
+
+void CustomTexManager::MarkRequested(Material* material) {
+    const auto order_it = prefetch_order.find(material);
+    if (order_it == prefetch_order.end()) {
+        return;
+    }
+    std::size_t num_evicted = 0;
+    {
+        std::scoped_lock lock{prefetch_mutex};
+        requested_order = std::max(requested_order, order_it->second);
+        std::erase_if(prefetched, [&](const PrefetchedMaterial& entry) {
+            if (entry.material != material &&
+                (entry.order + PREFETCH_SKIP_DISTANCE >= requested_order ||
+                 entry.material->IsPending())) {
+                return false;
+            }
+            prefetched_size -= entry.size;
+            if (entry.material != material && entry.material->IsDecoded() &&
+                entry.material->Unload()) {
+                num_evicted++;
+            }
+            return true;
+        });
+    }
+    prefetch_cv.notify_one();
+    if (num_evicted > 0) {
+        LOG_DEBUG(Render, "Freed {} prefetched custom textures the title skipped", num_evicted);
+    }
+}
+
 void CustomTexManager::CreateWorkers() {
     const std::size_t num_workers = std::max(std::thread::hardware_concurrency(), 2U) >> 1;
     workers = std::make_unique<Common::ThreadWorker>(num_workers, "Custom textures");
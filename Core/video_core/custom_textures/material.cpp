@@ -5,6 +5,7 @@
 #include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/texture.h"
+#include "common/zstd_compression.h"
 #include "core/frontend/image_interface.h"
 #include "video_core/custom_textures/material.h"
 
@@ -12,6 +13,21 @@ namespace VideoCore {
 
 namespace {
 
+constexpr u32 CACHE_MAGIC = 0x48434E50; // "PNCH"
+constexpr u32 CACHE_VERSION = 1;
+constexpr s32 CACHE_COMPRESSION_LEVEL = 3;
+
+struct CacheHeader {
+    u32 magic;
+    u32 version;
+    u64 source_size;
+    u64 source_time;
+    u32 width;
+    u32 height;
+    u32 flipped;
+    u32 reserved;
+};
+
 CustomPixelFormat ToCustomPixelFormat(ddsktx_format format) {
     switch (format) {
     case DDSKTX_FORMAT_RGBA8:
@@ -61,7 +77,14 @@ void CustomTexture::LoadFromDisk(bool flip_png) {
     }
 
     FileUtil::IOFile file{path, "rb"};
-    std::vector<u8> input(file.GetSize());
+    const u64 source_size = file.GetSize();
+    const bool use_cache = file_format == CustomFileFormat::PNG && !cache_path.empty();
+    const u64 source_time = use_cache ? FileUtil::GetModificationTime(path) : 0;
+    if (use_cache && source_time != 0 && LoadCached(source_size, source_time, flip_png)) {
+        return;
+    }
+
+    std::vector<u8> input(source_size);
     if (file.ReadBytes(input.data(), input.size()) != input.size()) {
         LOG_CRITICAL(Render, "Failed to open custom texture: {}", path);
         return;
@@ -69,6 +92,9 @@ void CustomTexture::LoadFromDisk(bool flip_png) {
     switch (file_format) {
     case CustomFileFormat::PNG:
         LoadPNG(input, flip_png);
+        if (use_cache && source_time != 0 && IsLoaded()) {
+            WriteCached(source_size, source_time, flip_png);
+        }
         break;
     case CustomFileFormat::DDS:
     case CustomFileFormat::KTX:
@@ -90,6 +116,56 @@ void CustomTexture::LoadPNG(std::span<const u8> input, bool flip_png) {
     format = CustomPixelFormat::RGBA8;
 }
 
+bool CustomTexture::LoadCached(u64 source_size, u64 source_time, bool flip_png) {
+    FileUtil::IOFile file{cache_path, "rb"};
+    if (!file.IsOpen()) {
+        return false;
+    }
+    CacheHeader header;
+    if (file.ReadBytes(&header, sizeof(header)) != sizeof(header) || header.magic != CACHE_MAGIC ||
+        header.version != CACHE_VERSION || header.source_size != source_size ||
+        header.source_time != source_time || header.flipped != static_cast<u32>(flip_png)) {
+        return false;
+    }
+    std::vector<u8> compressed(file.GetSize() - sizeof(header));
+    if (file.ReadBytes(compressed.data(), compressed.size()) != compressed.size()) {
+        return false;
+    }
+    std::vector<u8> pixels = Common::Compression::DecompressDataZSTD(compressed);
+    if (pixels.size() != static_cast<std::size_t>(header.width) * header.height * 4) {
+        LOG_WARNING(Render, "Discarding corrupted transcoding cache {}", cache_path);
+        return false;
+    }
+    data = std::move(pixels);
+    width = header.width;
+    height = header.height;
+    format = CustomPixelFormat::RGBA8;
+    return true;
+}
+
+void CustomTexture::WriteCached(u64 source_size, u64 source_time, bool flip_png) {
+    const CacheHeader header = {
+        .magic = CACHE_MAGIC,
+        .version = CACHE_VERSION,
+        .source_size = source_size,
+        .source_time = source_time,
+        .width = width,
+        .height = height,
+        .flipped = static_cast<u32>(flip_png),
+        .reserved = 0,
+    };
+    const std::vector<u8> compressed =
+        Common::Compression::CompressDataZSTD(data, CACHE_COMPRESSION_LEVEL);
+    if (compressed.empty() || !FileUtil::CreateFullPath(cache_path)) {
+        return;
+    }
+    FileUtil::IOFile file{cache_path, "wb"};
+    if (file.WriteBytes(&header, sizeof(header)) != sizeof(header) ||
+        file.WriteBytes(compressed.data(), compressed.size()) != compressed.size()) {
+        LOG_ERROR(Render, "Unable to write transcoding cache {}", cache_path);
+    }
+}
+
 void CustomTexture::LoadDDS(std::span<const u8> input) {
     ddsktx_format dds_format{};
     image_interface.DecodeDDS(data, width, height, dds_format, input);
@@ -141,6 +217,22 @@ void Material::LoadFromDisk(bool flip_png) noexcept {
     state = DecodeState::Decoded;
 }
 
+bool Material::Unload() noexcept {
+    for (const CustomTexture* texture : textures) {
+        if (texture && texture->hashes.size() > 1) {
+            return false;
+        }
+    }
+    for (CustomTexture* const texture : textures) {
+        if (texture) {
+            std::vector<u8>().swap(texture->data);
+        }
+    }
+    size = 0;
+    state = DecodeState::None;
+    return true;
+}
+
 void Material::AddMapTexture(CustomTexture* texture) noexcept {
     const std::size_t index = static_cast<std::size_t>(texture->type);
     if (textures[index]) {
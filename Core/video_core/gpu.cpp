@@ -214,6 +214,9 @@ void GPU::SetBufferSwap(u32 screen_id, const Service::GSP::FrameBufferInfo& info
 
     if (screen_id == 0) {
         MicroProfileFlip();
+        const auto vertex_cache_stats = impl->pica.TakeVertexCacheStats();
+        impl->system.perf_stats->AddVertexCacheStats(vertex_cache_stats.hits,
+                                                     vertex_cache_stats.misses);
         impl->system.perf_stats->EndGameFrame();
         right_eye_disabler->ReportEndFrame();
     }
@@ -330,6 +333,12 @@ void GPU::ReportLoadingProgramID(u64 program_ID) {
         }
     }
     impl->rasterizer->SetAccurateMul(use_accurate_mul);
+    impl->pica.SwitchDiskResources(program_ID);
+}
+
+void GPU::SwitchDiskResources(u64 title_id) {
+    impl->rasterizer->SwitchDiskResources(title_id);
+    impl->pica.SwitchDiskResources(title_id);
 }
 
 void GPU::SubmitCmdList(u32 index) {
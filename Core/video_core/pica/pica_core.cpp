@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <limits>
+#include <thread>
 #include "common/arch.h"
 #include "common/archives.h"
 #include "common/microprofile.h"
@@ -21,6 +23,9 @@ MICROPROFILE_DEFINE(GPU_Drawing, "GPU", "Drawing", MP_RGB(50, 50, 240));
 
 using namespace DebugUtils;
 
+// Vertex loaders are cached per attribute layout, the cache is cleared once it holds this many.
+constexpr std::size_t MAX_VERTEX_LOADERS = 256;
+
 union CommandHeader {
     u32 hex;
     BitField<0, 16, u32> cmd_id;
@@ -33,7 +38,8 @@ static_assert(sizeof(CommandHeader) == sizeof(u32), "CommandHeader has incorrect
 PicaCore::PicaCore(Memory::MemorySystem& memory_, std::shared_ptr<DebugContext> debug_context_)
     : memory{memory_}, debug_context{std::move(debug_context_)},
       geometry_pipeline{regs.internal, gs_unit, gs_setup},
-      shader_engine{CreateEngine(Settings::values.use_shader_jit.GetValue())} {
+      shader_engine{CreateEngine(Settings::values.use_shader_jit.GetValue())},
+      vertex_cache{Settings::values.vertex_cache_size.GetValue()} {
     InitializeRegs();
 
     const auto submit_vertex = [this](const AttributeBuffer& buffer) {
@@ -95,6 +101,10 @@ void PicaCore::SetInterruptHandler(Service::GSP::InterruptHandler& signal_interr
     this->signal_interrupt = signal_interrupt;
 }
 
+void PicaCore::SwitchDiskResources(u64 title_id) {
+    shader_engine->SwitchDiskCache(title_id);
+}
+
 void PicaCore::ProcessCmdList(PAddr list, u32 size, bool ignore_list) {
     if (ignore_list) {
         signal_interrupt(Service::GSP::InterruptId::P3D);
@@ -574,7 +584,17 @@ void PicaCore::LoadVertices(bool is_indexed) {
     // Read and validate vertex information from the loaders
     const auto& pipeline = regs.internal.pipeline;
     const PAddr base_address = pipeline.vertex_attributes.GetPhysicalBaseAddress();
-    const auto loader = VertexLoader(memory, pipeline);
+    const u64 loader_hash = VertexLoader::Hash(pipeline);
+    auto loader_it = vertex_loaders.find(loader_hash);
+    if (loader_it == vertex_loaders.end() || !loader_it->second.Matches(pipeline)) {
+        // A layout whose hash collides with a cached one replaces it.
+        if (loader_it == vertex_loaders.end() && vertex_loaders.size() >= MAX_VERTEX_LOADERS) {
+            vertex_loaders.clear();
+        }
+        loader_it = vertex_loaders.insert_or_assign(loader_hash, VertexLoader{pipeline}).first;
+    }
+    auto& loader = loader_it->second;
+    loader.Bind(memory, base_address);
     regs.internal.rasterizer.ValidateSemantics();
 
     // Locate index buffer.
@@ -583,16 +603,13 @@ void PicaCore::LoadVertices(bool is_indexed) {
     const u16* index_address_16 = reinterpret_cast<const u16*>(index_address_8);
     const bool index_u16 = index_info.format != 0;
 
-    // Simple circular-replacement vertex cache
-    const std::size_t VERTEX_CACHE_SIZE = 64;
-    std::array<bool, VERTEX_CACHE_SIZE> vertex_cache_valid{};
-    std::array<u16, VERTEX_CACHE_SIZE> vertex_cache_ids;
-    std::array<AttributeBuffer, VERTEX_CACHE_SIZE> vertex_cache;
-    u32 vertex_cache_pos = 0;
+    // Post-transform vertex cache, only used by indexed draws.
+    if (is_indexed) {
+        vertex_cache.Resize(Settings::values.vertex_cache_size.GetValue());
+        vertex_cache.Invalidate();
+    }
 
     // Compile the vertex shader for this batch.
-    ShaderUnit shader_unit;
-    AttributeBuffer vs_output;
     shader_engine->SetupBatch(vs_setup, regs.internal.vs.main_offset);
 
     // Setup geometry pipeline in case we are using a geometry shader.
@@ -600,56 +617,160 @@ void PicaCore::LoadVertices(bool is_indexed) {
     geometry_pipeline.Setup(shader_engine.get());
     ASSERT(!geometry_pipeline.NeedIndexInput() || is_indexed);
 
-    for (u32 index = 0; index < pipeline.num_vertices; ++index) {
+    const auto get_vertex = [&](u32 index) -> u32 {
         // Indexed rendering doesn't use the start offset
-        const u32 vertex = is_indexed
-                               ? (index_u16 ? index_address_16[index] : index_address_8[index])
-                               : (index + pipeline.vertex_offset);
+        return is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index])
+                          : (index + pipeline.vertex_offset);
+    };
 
-        bool vertex_cache_hit = false;
-        if (is_indexed) {
-            if (geometry_pipeline.NeedIndexInput()) {
-                geometry_pipeline.SubmitIndex(vertex);
-                continue;
+    if (is_indexed && geometry_pipeline.NeedIndexInput()) {
+        for (u32 index = 0; index < pipeline.num_vertices; ++index) {
+            geometry_pipeline.SubmitIndex(get_vertex(index));
+        }
+        return;
+    }
+
+    // Vertices are processed in groups. Cache misses of a group are gathered and shaded with
+    // a single engine invocation, then all outputs are passed to the sink in the original order.
+    const auto process_range = [&](u32 begin, u32 end, VertexCache& cache, auto&& sink) {
+        static constexpr std::size_t VERTEX_BATCH_SIZE = 8;
+        static constexpr u32 NO_SOURCE = std::numeric_limits<u32>::max();
+        std::array<ShaderUnit, VERTEX_BATCH_SIZE> shader_units;
+        std::array<AttributeBuffer, VERTEX_BATCH_SIZE> inputs;
+        std::array<AttributeBuffer, VERTEX_BATCH_SIZE> vs_outputs;
+        std::array<u32, VERTEX_BATCH_SIZE> batch_vertices;
+        std::array<u32, VERTEX_BATCH_SIZE> unit_ids;
+        std::array<u32, VERTEX_BATCH_SIZE> alias_ids;
+
+        for (u32 batch_start = begin; batch_start < end; batch_start += VERTEX_BATCH_SIZE) {
+            const u32 batch_size = std::min<u32>(VERTEX_BATCH_SIZE, end - batch_start);
+            u32 num_units = 0;
+
+            // Non-indexed groups are a contiguous vertex range, load it in one pass.
+            if (!is_indexed) {
+                loader.LoadVertices(get_vertex(batch_start), std::span{inputs.data(), batch_size},
+                                    input_default_attributes);
             }
 
-            for (u32 i = 0; i < VERTEX_CACHE_SIZE; ++i) {
-                if (vertex_cache_valid[i] && vertex == vertex_cache_ids[i]) {
-                    vs_output = vertex_cache[i];
-                    vertex_cache_hit = true;
-                    break;
+            for (u32 i = 0; i < batch_size; ++i) {
+                const u32 vertex = get_vertex(batch_start + i);
+                batch_vertices[i] = vertex;
+                unit_ids[i] = NO_SOURCE;
+                alias_ids[i] = NO_SOURCE;
+
+                if (is_indexed) {
+                    // Reuse a vertex shaded earlier in this group.
+                    for (u32 j = 0; j < i; ++j) {
+                        if (batch_vertices[j] == vertex) {
+                            alias_ids[i] = alias_ids[j] != NO_SOURCE ? alias_ids[j] : j;
+                            break;
+                        }
+                    }
+                    if (alias_ids[i] != NO_SOURCE) {
+                        continue;
+                    }
+
+                    if (const auto* cached = cache.Lookup(vertex)) {
+                        vs_outputs[i] = *cached;
+                        continue;
+                    }
+
+                    // Initialize data for the current vertex
+                    loader.LoadVertex(vertex, inputs[num_units], input_default_attributes);
                 }
-            }
-        }
+                const AttributeBuffer& input = inputs[num_units];
 
-        if (!vertex_cache_hit) {
-            // Initialize data for the current vertex
-            AttributeBuffer input;
-            loader.LoadVertex(base_address, index, vertex, input, input_default_attributes);
+                // Record vertex processing to the debugger.
+                if (debug_context) {
+                    debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
+                                           std::addressof(input));
+                }
 
-            // Record vertex processing to the debugger.
-            if (debug_context) {
-                debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
-                                       std::addressof(input));
+                shader_units[num_units].LoadInput(regs.internal.vs, input);
+                unit_ids[i] = num_units++;
             }
 
-            // Invoke the vertex shader for this vertex.
-            shader_unit.LoadInput(regs.internal.vs, input);
-            shader_engine->Run(vs_setup, shader_unit);
-            shader_unit.WriteOutput(regs.internal.vs, vs_output);
-
-            // Cache the vertex when doing indexed rendering.
-            if (is_indexed) {
-                vertex_cache[vertex_cache_pos] = vs_output;
-                vertex_cache_valid[vertex_cache_pos] = true;
-                vertex_cache_ids[vertex_cache_pos] = vertex;
-                vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
+            // Invoke the vertex shader for all vertices that missed the cache.
+            shader_engine->RunBatch(vs_setup, std::span{shader_units.data(), num_units});
+
+            for (u32 i = 0; i < batch_size; ++i) {
+                if (unit_ids[i] != NO_SOURCE) {
+                    shader_units[unit_ids[i]].WriteOutput(regs.internal.vs, vs_outputs[i]);
+
+                    // Cache the vertex when doing indexed rendering.
+                    if (is_indexed) {
+                        cache.Insert(batch_vertices[i], vs_outputs[i]);
+                    }
+                } else if (alias_ids[i] != NO_SOURCE) {
+                    vs_outputs[i] = vs_outputs[alias_ids[i]];
+                }
+
+                sink(batch_start + i, vs_outputs[i]);
             }
         }
+    };
+
+    // Large draws without a geometry shader can be shaded on multiple threads. The debugger
+    // expects shader invocations to be reported in order, so it forces the serial path.
+    static constexpr u32 MIN_PARALLEL_RANGE = 256;
+    const u32 num_vertices = pipeline.num_vertices;
+    const bool parallel = Settings::values.parallel_vertex_shading.GetValue() && !debug_context &&
+                          pipeline.use_gs != PipelineRegs::UseGS::Yes &&
+                          num_vertices >= 2 * MIN_PARALLEL_RANGE;
+    if (!parallel) {
+        process_range(0, num_vertices, vertex_cache, [this](u32, const AttributeBuffer& output) {
+            // Send to geometry pipeline
+            geometry_pipeline.SubmitVertex(output);
+        });
+        return;
+    }
+
+    if (!vertex_workers) {
+        const u32 num_workers = std::max(std::thread::hardware_concurrency(), 2U) - 1;
+        vertex_workers = std::make_unique<Common::ThreadWorker>(num_workers, "PicaVertexShader");
+    }
+
+    // Split the draw into contiguous ranges, each with its own vertex cache, and write the
+    // outputs into a shared buffer which is then submitted in order.
+    const u32 num_workers = static_cast<u32>(vertex_workers->NumWorkers());
+    const u32 range_size =
+        std::max(MIN_PARALLEL_RANGE, (num_vertices + num_workers - 1) / num_workers);
+    const u32 num_ranges = (num_vertices + range_size - 1) / range_size;
+    while (range_caches.size() < num_ranges) {
+        range_caches.emplace_back(Settings::values.vertex_cache_size.GetValue());
+    }
+    parallel_outputs.resize(num_vertices);
+
+    for (u32 range = 0; range < num_ranges; ++range) {
+        auto& cache = range_caches[range];
+        if (is_indexed) {
+            cache.Resize(Settings::values.vertex_cache_size.GetValue());
+            cache.Invalidate();
+        }
+        vertex_workers->QueueWork([&, range] {
+            const u32 begin = range * range_size;
+            const u32 end = std::min(begin + range_size, num_vertices);
+            process_range(begin, end, cache, [this](u32 index, const AttributeBuffer& output) {
+                parallel_outputs[index] = output;
+            });
+        });
+    }
+    vertex_workers->WaitForRequests();
+
+    for (u32 index = 0; index < num_vertices; ++index) {
+        geometry_pipeline.SubmitVertex(parallel_outputs[index]);
+    }
+}
 
-        // Send to geometry pipeline
-        geometry_pipeline.SubmitVertex(vs_output);
+VertexCache::Stats PicaCore::TakeVertexCacheStats() {
+    VertexCache::Stats stats = vertex_cache.GetStats();
+    vertex_cache.ResetStats();
+    for (VertexCache& cache : range_caches) {
+        stats.hits += cache.GetStats().hits;
+        stats.misses += cache.GetStats().misses;
+        cache.ResetStats();
     }
+    return stats;
 }
 
 PicaCore::RenderPropertiesGuess PicaCore::GuessCmdRenderProperties(PAddr list, u32 size) {
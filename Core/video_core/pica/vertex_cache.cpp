@@ -0,0 +1,36 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <bit>
+#include "video_core/pica/vertex_cache.h"
+
+namespace Pica {
+
+VertexCache::VertexCache(u32 num_entries) {
+    Resize(num_entries);
+}
+
+VertexCache::~VertexCache() = default;
+
+void VertexCache::Resize(u32 num_entries) {
+    const u32 num_sets = std::bit_ceil(std::max(num_entries, NUM_WAYS) / NUM_WAYS);
+    if (num_sets * NUM_WAYS == entries.size()) {
+        return;
+    }
+    entries.assign(num_sets * NUM_WAYS, Entry{});
+    lru.assign(num_sets, 0);
+    set_mask = num_sets - 1;
+    generation = 1;
+}
+
+void VertexCache::Invalidate() noexcept {
+    if (++generation == 0) [[unlikely]] {
+        // The generation counter wrapped around, entries from old draws could alias.
+        std::ranges::fill(entries, Entry{});
+        generation = 1;
+    }
+}
+
+} // namespace Pica
@@ -2,22 +2,62 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
 #include "common/alignment.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
+#include "core/memory.h"
 #include "video_core/pica/vertex_loader.h"
 
 namespace Pica {
 
-VertexLoader::VertexLoader(Memory::MemorySystem& memory_, const PipelineRegs& regs)
-    : memory{memory_} {
-    const auto& attribute_config = regs.vertex_attributes;
-    num_total_attributes = attribute_config.GetNumTotalAttributes();
+namespace {
 
-    vertex_attribute_sources.fill(0xdeadbeef);
+template <typename T, u32 NumElements>
+void LoadAttribute(const u8* source, Common::Vec4<f24>& out) {
+    const T* data = reinterpret_cast<const T*>(source);
+    for (u32 comp = 0; comp < NumElements; ++comp) {
+        out[comp] = f24::FromFloat32(static_cast<f32>(data[comp]));
+    }
 
-    for (u32 i = 0; i < 16; i++) {
-        vertex_attribute_is_default[i] = attribute_config.IsDefaultAttribute(i);
+    // Default attribute values set if array elements have < 4 components. This
+    // is *not* carried over from the default attribute settings even if they're
+    // enabled for this attribute.
+    for (u32 comp = NumElements; comp < 4; ++comp) {
+        out[comp] = comp == 3 ? f24::One() : f24::Zero();
     }
+}
+
+template <typename T>
+constexpr std::array<void (*)(const u8*, Common::Vec4<f24>&), 4> MakeKernels() {
+    return {&LoadAttribute<T, 1>, &LoadAttribute<T, 2>, &LoadAttribute<T, 3>,
+            &LoadAttribute<T, 4>};
+}
+
+/// Conversion kernels indexed by attribute format and element count.
+constexpr std::array<std::array<void (*)(const u8*, Common::Vec4<f24>&), 4>, 4> LOAD_KERNELS = {
+    MakeKernels<s8>(),
+    MakeKernels<u8>(),
+    MakeKernels<s16>(),
+    MakeKernels<f32>(),
+};
+
+/// Returns the attribute registers which describe the layout, skipping the base address.
+const u8* GetLayout(const PipelineRegs& regs) {
+    return reinterpret_cast<const u8*>(&regs.vertex_attributes) + sizeof(u32);
+}
+
+} // Anonymous namespace
+
+VertexLoader::VertexLoader(const PipelineRegs& regs) {
+    std::memcpy(layout.data(), GetLayout(regs), LAYOUT_SIZE);
+
+    const auto& attribute_config = regs.vertex_attributes;
+    num_total_attributes = attribute_config.GetNumTotalAttributes();
+
+    std::array<u32, 16> vertex_attribute_sources{};
+    std::array<u32, 16> vertex_attribute_strides{};
+    std::array<u32, 16> vertex_attribute_elements{};
 
     // Setup attribute data from loaders
     for (u32 loader = 0; loader < 12; ++loader) {
@@ -41,8 +81,6 @@ VertexLoader::VertexLoader(Memory::MemorySystem& memory_, const PipelineRegs& re
                 vertex_attribute_sources[attribute_index] = loader_config.data_offset + offset;
                 vertex_attribute_strides[attribute_index] =
                     static_cast<u32>(loader_config.byte_count);
-                vertex_attribute_formats[attribute_index] =
-                    attribute_config.GetFormat(attribute_index);
                 vertex_attribute_elements[attribute_index] =
                     attribute_config.GetNumElements(attribute_index);
                 offset += attribute_config.GetStride(attribute_index);
@@ -57,16 +95,12 @@ VertexLoader::VertexLoader(Memory::MemorySystem& memory_, const PipelineRegs& re
             }
         }
     }
-}
 
-VertexLoader::~VertexLoader() = default;
-
-void VertexLoader::LoadVertex(PAddr base_address, u32 index, u32 vertex, AttributeBuffer& input,
-                              AttributeBuffer& input_default_attributes) const {
+    // Compile the attribute layout into load steps.
     for (s32 i = 0; i < num_total_attributes; ++i) {
         // Load the default attribute if we're configured to do so
-        if (vertex_attribute_is_default[i]) {
-            input[i] = input_default_attributes[i];
+        if (attribute_config.IsDefaultAttribute(i)) {
+            steps.push_back({nullptr, static_cast<u32>(i), 0, 0, nullptr});
             continue;
         }
 
@@ -78,30 +112,62 @@ void VertexLoader::LoadVertex(PAddr base_address, u32 index, u32 vertex, Attribu
             continue;
         }
 
+        const auto format = static_cast<u32>(attribute_config.GetFormat(i));
+        steps.push_back({
+            .load = LOAD_KERNELS[format][vertex_attribute_elements[i] - 1],
+            .attribute = static_cast<u32>(i),
+            .source_offset = vertex_attribute_sources[i],
+            .stride = vertex_attribute_strides[i],
+            .source_ptr = nullptr,
+        });
+    }
+}
+
+VertexLoader::~VertexLoader() = default;
+
+u64 VertexLoader::Hash(const PipelineRegs& regs) {
+    return Common::ComputeHash64(GetLayout(regs), LAYOUT_SIZE);
+}
+
+bool VertexLoader::Matches(const PipelineRegs& regs) const {
+    return std::memcmp(layout.data(), GetLayout(regs), LAYOUT_SIZE) == 0;
+}
+
+void VertexLoader::Bind(Memory::MemorySystem& memory, PAddr base_address) {
+    for (Step& step : steps) {
+        if (step.load) {
+            step.source_ptr = memory.GetPhysicalPointer(base_address + step.source_offset);
+        }
+    }
+}
+
+void VertexLoader::LoadVertex(u32 vertex, AttributeBuffer& input,
+                              const AttributeBuffer& input_default_attributes) const {
+    for (const Step& step : steps) {
+        if (!step.load) {
+            input[step.attribute] = input_default_attributes[step.attribute];
+            continue;
+        }
+
         // Load per-vertex data from the loader arrays
-        const PAddr source_addr =
-            base_address + vertex_attribute_sources[i] + vertex_attribute_strides[i] * vertex;
-
-        switch (vertex_attribute_formats[i]) {
-        case PipelineRegs::VertexAttributeFormat::BYTE:
-            LoadAttribute<s8>(source_addr, i, input);
-            break;
-        case PipelineRegs::VertexAttributeFormat::UBYTE:
-            LoadAttribute<u8>(source_addr, i, input);
-            break;
-        case PipelineRegs::VertexAttributeFormat::SHORT:
-            LoadAttribute<s16>(source_addr, i, input);
-            break;
-        case PipelineRegs::VertexAttributeFormat::FLOAT:
-            LoadAttribute<f32>(source_addr, i, input);
-            break;
+        step.load(step.source_ptr + step.stride * vertex, input[step.attribute]);
+    }
+}
+
+void VertexLoader::LoadVertices(u32 first_vertex, std::span<AttributeBuffer> inputs,
+                                const AttributeBuffer& input_default_attributes) const {
+    for (const Step& step : steps) {
+        if (!step.load) {
+            for (AttributeBuffer& input : inputs) {
+                input[step.attribute] = input_default_attributes[step.attribute];
+            }
+            continue;
         }
 
-        // Default attribute values set if array elements have < 4 components. This
-        // is *not* carried over from the default attribute settings even if they're
-        // enabled for this attribute.
-        for (u32 comp = vertex_attribute_elements[i]; comp < 4; comp++) {
-            input[i][comp] = comp == 3 ? f24::One() : f24::Zero();
+        const u8* source = step.source_ptr + step.stride * first_vertex;
+        for (AttributeBuffer& input : inputs) {
+            step.load(source, input[step.attribute]);
+            source += step.stride;
         }
     }
 }
@@ -0,0 +1,375 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include "common/simd.h"
+#include "video_core/rasterizer_cache/morton_swizzle.h"
+
+namespace VideoCore {
+
+#if CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
+
+namespace {
+
+constexpr s8 FILL_ZERO = -1;
+constexpr s8 FILL_ONES = -2;
+constexpr u8 NO_SOURCE = 0x80;
+
+/**
+ * Describes a format conversion that only moves bytes around. When unswizzling, map holds the
+ * tiled byte copied to each linear byte, or one of the fill values. When swizzling, it holds the
+ * linear byte copied to each tiled byte.
+ */
+struct PixelShuffle {
+    u32 tiled_bpp;
+    u32 linear_bpp;
+    std::array<s8, 4> map;
+};
+
+/**
+ * Byte lookups producing two 16 byte outputs from a 32 byte table held in two registers.
+ * index addresses the whole table while lo/hi address each half, with NO_SOURCE for bytes
+ * that come from the other half or from fill.
+ */
+struct ShuffleMasks {
+    std::array<std::array<u8, 16>, 2> index{};
+    std::array<std::array<u8, 16>, 2> lo{};
+    std::array<std::array<u8, 16>, 2> hi{};
+    std::array<std::array<u8, 16>, 2> fill{};
+
+    constexpr void Set(u32 out, u32 byte, u32 table_index) {
+        index[out][byte] = static_cast<u8>(table_index);
+        lo[out][byte] = table_index < 16 ? static_cast<u8>(table_index) : NO_SOURCE;
+        hi[out][byte] = table_index < 16 ? NO_SOURCE : static_cast<u8>(table_index - 16);
+    }
+
+    constexpr void Fill(u32 out, u32 byte, s8 value) {
+        index[out][byte] = 0xFF;
+        lo[out][byte] = NO_SOURCE;
+        hi[out][byte] = NO_SOURCE;
+        fill[out][byte] = value == FILL_ONES ? 0xFF : 0;
+    }
+};
+
+/*
+ * Every tile is stored as eight chunks of eight pixels, each chunk covering a 4x2 block:
+ *
+ *   2 3 6 7
+ *   0 1 4 5
+ *
+ * Chunk c holds the block at x = 4 * c[1], y = 4 * c[2] + 2 * c[0], so each chunk maps to half of
+ * two consecutive linear rows and can be converted with a single shuffle per row.
+ */
+constexpr u32 ChunkX(u32 chunk) {
+    return (chunk & 2) * 2;
+}
+
+constexpr u32 ChunkY(u32 chunk) {
+    return (chunk & 4) + (chunk & 1) * 2;
+}
+
+/// Index of the chunk pixel at position x of the row in the 4x2 block.
+constexpr u32 ChunkPixel(u32 row, u32 x) {
+    return ((x >> 1) << 2) | (row << 1) | (x & 1);
+}
+
+/// Unswizzling reads the chunk into the table and writes one output per linear row.
+constexpr ShuffleMasks MakeDecodeMasks(PixelShuffle shuffle) {
+    const u32 chunk_size = 8 * shuffle.tiled_bpp;
+    ShuffleMasks masks{};
+    for (u32 row = 0; row < 2; row++) {
+        for (u32 byte = 0; byte < 16; byte++) {
+            if (byte >= 4 * shuffle.linear_bpp) {
+                masks.Fill(row, byte, FILL_ZERO);
+                continue;
+            }
+            const s8 source = shuffle.map[byte % shuffle.linear_bpp];
+            if (source < 0) {
+                masks.Fill(row, byte, source);
+                continue;
+            }
+            const u32 pixel = ChunkPixel(row, byte / shuffle.linear_bpp);
+            const u32 offset = pixel * shuffle.tiled_bpp + source;
+            // 24 byte chunks are loaded as two overlapping vectors at offsets 0 and 8.
+            masks.Set(row, byte, chunk_size == 24 && offset >= 16 ? offset + 8 : offset);
+        }
+    }
+    return masks;
+}
+
+/// Swizzling reads the two linear rows into the table and writes the chunk in two halves.
+constexpr ShuffleMasks MakeEncodeMasks(PixelShuffle shuffle) {
+    ShuffleMasks masks{};
+    for (u32 byte = 0; byte < 32; byte++) {
+        if (byte >= 8 * shuffle.tiled_bpp) {
+            masks.Fill(byte / 16, byte % 16, FILL_ZERO);
+            continue;
+        }
+        const u32 pixel = byte / shuffle.tiled_bpp;
+        const u32 row = (pixel >> 1) & 1;
+        const u32 x = ((pixel >> 2) << 1) | (pixel & 1);
+        const u32 source = static_cast<u32>(shuffle.map[byte % shuffle.tiled_bpp]);
+        masks.Set(byte / 16, byte % 16, row * 16 + x * shuffle.linear_bpp + source);
+    }
+    return masks;
+}
+
+template <PixelShuffle shuffle>
+constexpr ShuffleMasks DECODE_MASKS = MakeDecodeMasks(shuffle);
+
+template <PixelShuffle shuffle>
+constexpr ShuffleMasks ENCODE_MASKS = MakeEncodeMasks(shuffle);
+
+template <PixelShuffle shuffle>
+constexpr bool HasFill() {
+    for (u32 i = 0; i < shuffle.linear_bpp; i++) {
+        if (shuffle.map[i] < 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#if CITRA_ARCH(x86_64)
+
+using Vector = __m128i;
+
+SIMD_TARGET inline Vector LoadMask(const std::array<u8, 16>& mask) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask.data()));
+}
+
+template <u32 size>
+SIMD_TARGET inline Vector LoadBytes(const u8* source) {
+    if constexpr (size == 16) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+    } else if constexpr (size == 8) {
+        return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source));
+    } else {
+        alignas(16) std::array<u8, 16> bytes{};
+        std::memcpy(bytes.data(), source, size);
+        return _mm_load_si128(reinterpret_cast<const __m128i*>(bytes.data()));
+    }
+}
+
+template <u32 size>
+SIMD_TARGET inline void StoreBytes(u8* dest, Vector value) {
+    if constexpr (size == 16) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), value);
+    } else if constexpr (size == 8) {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dest), value);
+    } else {
+        alignas(16) std::array<u8, 16> bytes;
+        _mm_store_si128(reinterpret_cast<__m128i*>(bytes.data()), value);
+        std::memcpy(dest, bytes.data(), size);
+    }
+}
+
+SIMD_TARGET inline Vector ZeroVector() {
+    return _mm_setzero_si128();
+}
+
+template <bool use_hi, bool use_fill>
+SIMD_TARGET inline Vector Shuffle(Vector lo, Vector hi, const ShuffleMasks& masks, u32 out) {
+    // pshufb only addresses 16 bytes, so larger tables are looked up in two halves.
+    Vector result = _mm_shuffle_epi8(lo, LoadMask(masks.lo[out]));
+    if constexpr (use_hi) {
+        result = _mm_or_si128(result, _mm_shuffle_epi8(hi, LoadMask(masks.hi[out])));
+    }
+    if constexpr (use_fill) {
+        result = _mm_or_si128(result, LoadMask(masks.fill[out]));
+    }
+    return result;
+}
+
+#elif CITRA_ARCH(arm64)
+
+using Vector = uint8x16_t;
+
+template <u32 size>
+inline Vector LoadBytes(const u8* source) {
+    if constexpr (size == 16) {
+        return vld1q_u8(source);
+    } else if constexpr (size == 8) {
+        return vcombine_u8(vld1_u8(source), vdup_n_u8(0));
+    } else {
+        std::array<u8, 16> bytes{};
+        std::memcpy(bytes.data(), source, size);
+        return vld1q_u8(bytes.data());
+    }
+}
+
+template <u32 size>
+inline void StoreBytes(u8* dest, Vector value) {
+    if constexpr (size == 16) {
+        vst1q_u8(dest, value);
+    } else if constexpr (size == 8) {
+        vst1_u8(dest, vget_low_u8(value));
+    } else {
+        std::array<u8, 16> bytes;
+        vst1q_u8(bytes.data(), value);
+        std::memcpy(dest, bytes.data(), size);
+    }
+}
+
+inline Vector ZeroVector() {
+    return vdupq_n_u8(0);
+}
+
+template <bool use_hi, bool use_fill>
+inline Vector Shuffle(Vector lo, Vector hi, const ShuffleMasks& masks, u32 out) {
+    // Out of range indices produce zero, which leaves room for the fill values.
+    const Vector index = vld1q_u8(masks.index[out].data());
+    Vector result;
+    if constexpr (use_hi) {
+        result = vqtbl2q_u8(uint8x16x2_t{{lo, hi}}, index);
+    } else {
+        result = vqtbl1q_u8(lo, index);
+    }
+    if constexpr (use_fill) {
+        result = vorrq_u8(result, vld1q_u8(masks.fill[out].data()));
+    }
+    return result;
+}
+
+#endif
+
+template <PixelShuffle shuffle>
+SIMD_TARGET void DecodeTile(u32 stride, u8* tile, u8* linear) {
+    constexpr const ShuffleMasks& masks = DECODE_MASKS<shuffle>;
+    constexpr u32 chunk_size = 8 * shuffle.tiled_bpp;
+    constexpr u32 row_size = 4 * shuffle.linear_bpp;
+    constexpr bool use_hi = chunk_size > 16;
+    constexpr bool use_fill = HasFill<shuffle>();
+    const u32 linear_stride = stride * shuffle.linear_bpp;
+
+    for (u32 chunk = 0; chunk < 8; chunk++) {
+        const u8* source = tile + chunk * chunk_size;
+        Vector lo, hi;
+        if constexpr (use_hi) {
+            lo = LoadBytes<16>(source);
+            hi = LoadBytes<16>(source + chunk_size - 16);
+        } else {
+            lo = LoadBytes<chunk_size>(source);
+            hi = ZeroVector();
+        }
+
+        u8* dest =
+            linear + (7 - ChunkY(chunk)) * linear_stride + ChunkX(chunk) * shuffle.linear_bpp;
+        StoreBytes<row_size>(dest, Shuffle<use_hi, use_fill>(lo, hi, masks, 0));
+        StoreBytes<row_size>(dest - linear_stride, Shuffle<use_hi, use_fill>(lo, hi, masks, 1));
+    }
+}
+
+template <PixelShuffle shuffle>
+SIMD_TARGET void EncodeTile(u32 stride, u8* tile, u8* linear) {
+    constexpr const ShuffleMasks& masks = ENCODE_MASKS<shuffle>;
+    constexpr u32 chunk_size = 8 * shuffle.tiled_bpp;
+    constexpr u32 row_size = 4 * shuffle.linear_bpp;
+    const u32 linear_stride = stride * shuffle.linear_bpp;
+
+    for (u32 chunk = 0; chunk < 8; chunk++) {
+        const u8* source =
+            linear + (7 - ChunkY(chunk)) * linear_stride + ChunkX(chunk) * shuffle.linear_bpp;
+        const Vector row0 = LoadBytes<row_size>(source);
+        const Vector row1 = LoadBytes<row_size>(source - linear_stride);
+
+        u8* dest = tile + chunk * chunk_size;
+        if constexpr (chunk_size > 16) {
+            StoreBytes<16>(dest, Shuffle<true, false>(row0, row1, masks, 0));
+            StoreBytes<chunk_size - 16>(dest + 16, Shuffle<true, false>(row0, row1, masks, 1));
+        } else {
+            StoreBytes<chunk_size>(dest, Shuffle<true, false>(row0, row1, masks, 0));
+        }
+    }
+}
+
+constexpr PixelShuffle COPY_16{2, 2, {0, 1}};
+constexpr PixelShuffle COPY_24{3, 3, {0, 1, 2}};
+constexpr PixelShuffle COPY_32{4, 4, {0, 1, 2, 3}};
+
+constexpr PixelShuffle DECODE_RGBA8{4, 4, {3, 2, 1, 0}};
+constexpr PixelShuffle DECODE_RGB8{3, 4, {2, 1, 0, FILL_ONES}};
+constexpr PixelShuffle DECODE_IA8{2, 4, {1, 1, 1, 0}};
+constexpr PixelShuffle DECODE_RG8{2, 4, {1, 0, FILL_ZERO, FILL_ONES}};
+constexpr PixelShuffle DECODE_I8{1, 4, {0, 0, 0, FILL_ONES}};
+constexpr PixelShuffle DECODE_A8{1, 4, {FILL_ZERO, FILL_ZERO, FILL_ZERO, 0}};
+constexpr PixelShuffle DECODE_D24S8{4, 4, {3, 0, 1, 2}};
+
+constexpr PixelShuffle ENCODE_RGBA8{4, 4, {3, 2, 1, 0}};
+constexpr PixelShuffle ENCODE_RGB8{3, 4, {2, 1, 0}};
+constexpr PixelShuffle ENCODE_RG8{2, 4, {1, 0}};
+constexpr PixelShuffle ENCODE_A8{1, 4, {3}};
+constexpr PixelShuffle ENCODE_D24{3, 4, {0, 1, 2}};
+constexpr PixelShuffle ENCODE_D24S8{4, 4, {1, 2, 3, 0}};
+
+struct TileKernels {
+    MortonTileFunc decode;
+    MortonTileFunc encode;
+    MortonTileFunc decode_converted;
+    MortonTileFunc encode_converted;
+};
+
+// Formats whose conversion involves arithmetic, along with the 4 bit and compressed ones, and
+// the cases where the scalar path leaves padding bytes untouched, stay on the scalar path.
+constexpr std::array<TileKernels, PIXEL_FORMAT_COUNT> KERNELS = {{
+    // RGBA8
+    {DecodeTile<COPY_32>, EncodeTile<COPY_32>, DecodeTile<DECODE_RGBA8>, EncodeTile<ENCODE_RGBA8>},
+    // RGB8
+    {DecodeTile<COPY_24>, EncodeTile<COPY_24>, DecodeTile<DECODE_RGB8>, EncodeTile<ENCODE_RGB8>},
+    // RGB5A1
+    {DecodeTile<COPY_16>, EncodeTile<COPY_16>, nullptr, nullptr},
+    // RGB565
+    {DecodeTile<COPY_16>, EncodeTile<COPY_16>, nullptr, nullptr},
+    // RGBA4
+    {DecodeTile<COPY_16>, EncodeTile<COPY_16>, nullptr, nullptr},
+    // IA8
+    {DecodeTile<DECODE_IA8>, nullptr, DecodeTile<DECODE_IA8>, nullptr},
+    // RG8
+    {DecodeTile<DECODE_RG8>, EncodeTile<ENCODE_RG8>, DecodeTile<DECODE_RG8>,
+     EncodeTile<ENCODE_RG8>},
+    // I8
+    {DecodeTile<DECODE_I8>, nullptr, DecodeTile<DECODE_I8>, nullptr},
+    // A8
+    {DecodeTile<DECODE_A8>, EncodeTile<ENCODE_A8>, DecodeTile<DECODE_A8>, EncodeTile<ENCODE_A8>},
+    // IA4, I4, A4, ETC1, ETC1A4
+    {},
+    {},
+    {},
+    {},
+    {},
+    // D16
+    {DecodeTile<COPY_16>, EncodeTile<COPY_16>, nullptr, nullptr},
+    // Invalid
+    {},
+    // D24
+    {nullptr, EncodeTile<ENCODE_D24>, nullptr, nullptr},
+    // D24S8
+    {DecodeTile<DECODE_D24S8>, EncodeTile<ENCODE_D24S8>, DecodeTile<DECODE_D24S8>,
+     EncodeTile<ENCODE_D24S8>},
+}};
+
+} // Anonymous namespace
+
+MortonTileFunc GetMortonTileFunc(bool morton_to_linear, PixelFormat format, bool converted) {
+    const std::size_t index = static_cast<std::size_t>(format);
+    if (!Common::HostSupportsSimd() || index >= KERNELS.size()) {
+        return nullptr;
+    }
+    const TileKernels& kernels = KERNELS[index];
+    if (morton_to_linear) {
+        return converted ? kernels.decode_converted : kernels.decode;
+    }
+    return converted ? kernels.encode_converted : kernels.encode;
+}
+
+#else
+
+MortonTileFunc GetMortonTileFunc(bool, PixelFormat, bool) {
+    return nullptr;
+}
+
+#endif
+
+} // namespace VideoCore
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include "common/alignment.h"
 #include "video_core/custom_textures/material.h"
 #include "video_core/rasterizer_cache/surface_base.h"
@@ -126,6 +127,25 @@ bool SurfaceBase::HasNormalMap() const noexcept {
     return material && material->Map(MapType::Normal) != nullptr;
 }
 
+std::optional<u64> SurfaceBase::GetCachedHash(SurfaceInterval interval, bool new_hash) const {
+    const auto it = std::ranges::find_if(hash_cache, [&](const HashEntry& entry) {
+        return entry.interval == interval && entry.new_hash == new_hash;
+    });
+    if (it == hash_cache.end()) {
+        return std::nullopt;
+    }
+    return it->hash;
+}
+
+void SurfaceBase::CacheHash(SurfaceInterval interval, bool new_hash, u64 hash) {
+    // Surfaces are uploaded in a handful of intervals at most, keep only the recent ones.
+    constexpr std::size_t MAX_CACHED_HASHES = 8;
+    if (hash_cache.size() == MAX_CACHED_HASHES) {
+        hash_cache.erase(hash_cache.begin());
+    }
+    hash_cache.push_back({interval, new_hash, hash});
+}
+
 ClearValue SurfaceBase::MakeClearValue(PAddr copy_addr, PixelFormat dst_format) {
     const SurfaceType dst_type = GetFormatType(dst_format);
     const std::array fill_buffer = MakeFillBuffer(copy_addr);
@@ -0,0 +1,116 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/assert.h"
+#include "video_core/rasterizer_cache/surface_page_table.h"
+
+namespace VideoCore {
+
+const SurfacePageTable::Page SurfacePageTable::EMPTY_PAGE{};
+
+SurfacePageTable::SurfacePageTable() : pages(NUM_PAGES) {}
+
+SurfacePageTable::~SurfacePageTable() = default;
+
+SurfaceId SurfacePageTable::Back(u64 page) const {
+    if (page >= NUM_PAGES || pages[page].count == 0) {
+        return SurfaceId{};
+    }
+    const Page& entry = pages[page];
+    const u32 index = entry.count - 1;
+    if (index < INLINE_SURFACES) {
+        return entry.surfaces[index];
+    }
+    return blocks[BlockOf(entry, index)].surfaces[(index - INLINE_SURFACES) % BLOCK_SURFACES];
+}
+
+void SurfacePageTable::Insert(u64 page, SurfaceId surface_id) {
+    ASSERT(page < NUM_PAGES);
+    Page& entry = pages[page];
+    const u32 index = entry.count;
+
+    // Append a new block to the end of the chain when the last one is full.
+    if (index >= INLINE_SURFACES && (index - INLINE_SURFACES) % BLOCK_SURFACES == 0) {
+        u32 new_block = free_block;
+        if (new_block != INVALID_BLOCK) {
+            free_block = blocks[new_block].next;
+        } else {
+            new_block = static_cast<u32>(blocks.size());
+            blocks.emplace_back();
+        }
+        blocks[new_block].next = INVALID_BLOCK;
+
+        if (entry.overflow == INVALID_BLOCK) {
+            entry.overflow = new_block;
+        } else {
+            u32 tail = entry.overflow;
+            while (blocks[tail].next != INVALID_BLOCK) {
+                tail = blocks[tail].next;
+            }
+            blocks[tail].next = new_block;
+        }
+    }
+
+    Slot(entry, index) = surface_id;
+    entry.count++;
+}
+
+bool SurfacePageTable::Erase(u64 page, SurfaceId surface_id) {
+    if (page >= NUM_PAGES) {
+        return false;
+    }
+    Page& entry = pages[page];
+
+    u32 index = 0;
+    for (const SurfaceId id : Surfaces(page)) {
+        if (id == surface_id) {
+            break;
+        }
+        index++;
+    }
+    if (index == entry.count) {
+        return false;
+    }
+
+    // Move the last surface into the hole so the page stays compact.
+    const u32 last = entry.count - 1;
+    Slot(entry, index) = Slot(entry, last);
+    entry.count = last;
+
+    // Return the tail block to the pool once it no longer holds any surface.
+    if (last >= INLINE_SURFACES && (last - INLINE_SURFACES) % BLOCK_SURFACES == 0) {
+        u32* link = &entry.overflow;
+        while (blocks[*link].next != INVALID_BLOCK) {
+            link = &blocks[*link].next;
+        }
+        blocks[*link].next = free_block;
+        free_block = *link;
+        *link = INVALID_BLOCK;
+    }
+    return true;
+}
+
+void SurfacePageTable::Clear() {
+    std::fill(pages.begin(), pages.end(), Page{});
+    blocks.clear();
+    free_block = INVALID_BLOCK;
+}
+
+SurfaceId& SurfacePageTable::Slot(Page& page, u32 index) {
+    if (index < INLINE_SURFACES) {
+        return page.surfaces[index];
+    }
+    return blocks[BlockOf(page, index)].surfaces[(index - INLINE_SURFACES) % BLOCK_SURFACES];
+}
+
+u32 SurfacePageTable::BlockOf(const Page& page, u32 index) const {
+    u32 block = page.overflow;
+    for (u32 skip = (index - INLINE_SURFACES) / BLOCK_SURFACES; skip > 0; --skip) {
+        block = blocks[block].next;
+    }
+    return block;
+}
+
+} // namespace VideoCore
@@ -0,0 +1,102 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include "common/color.h"
+#include "core/core.h"
+#include "video_core/pica/pica_core.h"
+#include "video_core/renderer_software/renderer_software.h"
+
+namespace SwRenderer {
+
+RendererSoftware::RendererSoftware(Core::System& system, Pica::PicaCore& pica_,
+                                   Frontend::EmuWindow& window)
+    : VideoCore::RendererBase{system, window, nullptr}, memory{system.Memory()}, pica{pica_},
+      rasterizer{memory, pica} {}
+
+RendererSoftware::~RendererSoftware() = default;
+
+void RendererSoftware::SwapBuffers() {
+    PrepareRenderTarget();
+    EndFrame();
+}
+
+void RendererSoftware::PrepareRenderTarget() {
+    const auto& regs_lcd = pica.regs_lcd;
+    for (u32 i = 0; i < 3; i++) {
+        const u32 fb_id = i == 2 ? 1 : 0;
+        const auto& framebuffer = pica.regs.framebuffer_config[fb_id];
+        auto& info = screen_infos[i];
+
+        const auto color_fill = fb_id == 0 ? regs_lcd.color_fill_top : regs_lcd.color_fill_bottom;
+        if (color_fill.is_enabled) {
+            info.width = framebuffer.height;
+            info.height = framebuffer.width;
+            info.pixels.resize(info.width * info.height * 4);
+            const auto color = color_fill.AsVector();
+            for (std::size_t offset = 0; offset < info.pixels.size(); offset += 4) {
+                info.pixels[offset] = color.r();
+                info.pixels[offset + 1] = color.g();
+                info.pixels[offset + 2] = color.b();
+                info.pixels[offset + 3] = 255;
+            }
+            continue;
+        }
+
+        LoadFBToScreenInfo(i);
+    }
+}
+
+void RendererSoftware::LoadFBToScreenInfo(int index) {
+    const u32 fb_id = index == 2 ? 1 : 0;
+    const bool right_eye = index == 1;
+    const auto& framebuffer = pica.regs.framebuffer_config[fb_id];
+    auto& info = screen_infos[index];
+
+    const PAddr framebuffer_addr =
+        framebuffer.active_fb == 0
+            ? (right_eye ? framebuffer.address_right1 : framebuffer.address_left1)
+            : (right_eye ? framebuffer.address_right2 : framebuffer.address_left2);
+    const u8* framebuffer_data = memory.GetPhysicalPointer(framebuffer_addr);
+    if (!framebuffer_data) {
+        return;
+    }
+
+    // The LCD framebuffers are stored rotated, each row in memory is a column on the screen
+    // starting from the bottom.
+    const u32 bpp = Pica::BytesPerPixel(framebuffer.color_format);
+    const u32 stride = framebuffer.stride;
+    const u32 rows = framebuffer.height;
+    const u32 columns = framebuffer.width;
+    info.width = rows;
+    info.height = columns;
+    info.pixels.resize(rows * columns * 4);
+
+    for (u32 row = 0; row < rows; row++) {
+        for (u32 column = 0; column < columns; column++) {
+            const u8* pixel = framebuffer_data + row * stride + column * bpp;
+            const Common::Vec4<u8> color = [&] {
+                switch (framebuffer.color_format) {
+                case Pica::PixelFormat::RGBA8:
+                    return Common::Color::DecodeRGBA8(pixel);
+                case Pica::PixelFormat::RGB8:
+                    return Common::Color::DecodeRGB8(pixel);
+                case Pica::PixelFormat::RGB565:
+                    return Common::Color::DecodeRGB565(pixel);
+                case Pica::PixelFormat::RGB5A1:
+                    return Common::Color::DecodeRGB5A1(pixel);
+                case Pica::PixelFormat::RGBA4:
+                    return Common::Color::DecodeRGBA4(pixel);
+                default:
+                    UNREACHABLE();
+                    return Common::Vec4<u8>{};
+                }
+            }();
+            const u32 output_offset = ((columns - 1 - column) * rows + row) * 4;
+            std::memcpy(info.pixels.data() + output_offset, color.AsArray(), sizeof(color));
+        }
+    }
+}
+
+} // namespace SwRenderer
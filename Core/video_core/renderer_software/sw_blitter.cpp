@@ -2,8 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
 #include "common/alignment.h"
 #include "common/color.h"
+#include "common/simd.h"
 #include "common/vector_math.h"
 #include "core/memory.h"
 #include "video_core/pica/regs_external.h"
@@ -13,24 +15,209 @@
 
 namespace SwRenderer {
 
-static Common::Vec4<u8> DecodePixel(Pica::PixelFormat input_format, const u8* src_pixel) {
-    switch (input_format) {
+namespace {
+
+/**
+ * The row kernels work on pixels stored with the byte order of Pica::PixelFormat::RGBA8, so
+ * transfers from and to RGBA8 need no conversion at all and averaging works on plain bytes.
+ */
+constexpr u32 PIXEL_SIZE = 4;
+
+#if CITRA_ARCH(x86_64)
+
+SIMD_TARGET u32 DecodeRGB8Simd(const u8* source, u8* pixels, u32 count) {
+    const __m128i shuffle = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    const __m128i alpha = _mm_set1_epi32(0xFF);
+    u32 x = 0;
+    // Each load reads 16 bytes while only 12 are used, keep it inside the source row.
+    for (; x + 6 <= count; x += 4) {
+        const __m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 3));
+        const __m128i rgba = _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + x * PIXEL_SIZE), rgba);
+    }
+    return x;
+}
+
+SIMD_TARGET u32 EncodeRGB8Simd(const u8* pixels, u8* dest, u32 count) {
+    const __m128i shuffle = _mm_setr_epi8(1, 2, 3, 5, 6, 7, 9, 10, 11, 13, 14, 15, -1, -1, -1, -1);
+    u32 x = 0;
+    // Each store writes 16 bytes while only 12 are valid, the next one overwrites the rest.
+    for (; x + 6 <= count; x += 4) {
+        const __m128i rgba =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + x * PIXEL_SIZE));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + x * 3), _mm_shuffle_epi8(rgba, shuffle));
+    }
+    return x;
+}
+
+#elif CITRA_ARCH(arm64)
+
+u32 DecodeRGB8Simd(const u8* source, u8* pixels, u32 count) {
+    u32 x = 0;
+    for (; x + 16 <= count; x += 16) {
+        const uint8x16x3_t rgb = vld3q_u8(source + x * 3);
+        const uint8x16x4_t rgba = {vdupq_n_u8(0xFF), rgb.val[0], rgb.val[1], rgb.val[2]};
+        vst4q_u8(pixels + x * PIXEL_SIZE, rgba);
+    }
+    return x;
+}
+
+u32 EncodeRGB8Simd(const u8* pixels, u8* dest, u32 count) {
+    u32 x = 0;
+    for (; x + 16 <= count; x += 16) {
+        const uint8x16x4_t rgba = vld4q_u8(pixels + x * PIXEL_SIZE);
+        const uint8x16x3_t rgb = {rgba.val[1], rgba.val[2], rgba.val[3]};
+        vst3q_u8(dest + x * 3, rgb);
+    }
+    return x;
+}
+
+#else
+
+u32 DecodeRGB8Simd(const u8*, u8*, u32) {
+    return 0;
+}
+
+u32 EncodeRGB8Simd(const u8*, u8*, u32) {
+    return 0;
+}
+
+#endif
+
+template <auto decode>
+void DecodeRowWith(const u8* source, u8* pixels, u32 count, u32 bytes_per_pixel) {
+    for (u32 x = 0; x < count; x++) {
+        Common::Color::EncodeRGBA8(decode(source + x * bytes_per_pixel), pixels + x * PIXEL_SIZE);
+    }
+}
+
+template <auto encode>
+void EncodeRowWith(const u8* pixels, u8* dest, u32 count, u32 bytes_per_pixel) {
+    for (u32 x = 0; x < count; x++) {
+        encode(Common::Color::DecodeRGBA8(pixels + x * PIXEL_SIZE), dest + x * bytes_per_pixel);
+    }
+}
+
+/// Converts a row of pixels of the provided format to the kernel pixel layout.
+void DecodeRow(Pica::PixelFormat format, const u8* source, u8* pixels, u32 count) {
+    const bool has_simd = Common::HostSupportsSimd();
+    switch (format) {
+    case Pica::PixelFormat::RGBA8:
+        std::memcpy(pixels, source, count * PIXEL_SIZE);
+        break;
+    case Pica::PixelFormat::RGB8: {
+        const u32 done = has_simd ? DecodeRGB8Simd(source, pixels, count) : 0;
+        DecodeRowWith<Common::Color::DecodeRGB8>(source + done * 3, pixels + done * PIXEL_SIZE,
+                                                 count - done, 3);
+        break;
+    }
+    case Pica::PixelFormat::RGB565:
+        DecodeRowWith<Common::Color::DecodeRGB565>(source, pixels, count, 2);
+        break;
+    case Pica::PixelFormat::RGB5A1:
+        DecodeRowWith<Common::Color::DecodeRGB5A1>(source, pixels, count, 2);
+        break;
+    case Pica::PixelFormat::RGBA4:
+        DecodeRowWith<Common::Color::DecodeRGBA4>(source, pixels, count, 2);
+        break;
+    default:
+        LOG_ERROR(HW_GPU, "Unknown source framebuffer format {:x}", format);
+        std::memset(pixels, 0, count * PIXEL_SIZE);
+        break;
+    }
+}
+
+/// Converts a row of pixels in the kernel pixel layout to the provided format.
+void EncodeRow(Pica::PixelFormat format, const u8* pixels, u8* dest, u32 count) {
+    const bool has_simd = Common::HostSupportsSimd();
+    switch (format) {
     case Pica::PixelFormat::RGBA8:
-        return Common::Color::DecodeRGBA8(src_pixel);
-    case Pica::PixelFormat::RGB8:
-        return Common::Color::DecodeRGB8(src_pixel);
+        std::memcpy(dest, pixels, count * PIXEL_SIZE);
+        break;
+    case Pica::PixelFormat::RGB8: {
+        const u32 done = has_simd ? EncodeRGB8Simd(pixels, dest, count) : 0;
+        EncodeRowWith<Common::Color::EncodeRGB8>(pixels + done * PIXEL_SIZE, dest + done * 3,
+                                                 count - done, 3);
+        break;
+    }
     case Pica::PixelFormat::RGB565:
-        return Common::Color::DecodeRGB565(src_pixel);
+        EncodeRowWith<Common::Color::EncodeRGB565>(pixels, dest, count, 2);
+        break;
     case Pica::PixelFormat::RGB5A1:
-        return Common::Color::DecodeRGB5A1(src_pixel);
+        EncodeRowWith<Common::Color::EncodeRGB5A1>(pixels, dest, count, 2);
+        break;
     case Pica::PixelFormat::RGBA4:
-        return Common::Color::DecodeRGBA4(src_pixel);
+        EncodeRowWith<Common::Color::EncodeRGBA4>(pixels, dest, count, 2);
+        break;
     default:
-        LOG_ERROR(HW_GPU, "Unknown source framebuffer format {:x}", input_format);
-        return {0, 0, 0, 0};
+        LOG_ERROR(HW_GPU, "Unknown destination framebuffer format {:x}", format);
+        break;
+    }
+}
+
+constexpr u32 EVEN_BYTES = 0x00FF00FF;
+
+/// Averages the channels of two pixels, rounding down, with each channel in a 16-bit lane.
+constexpr u32 Average2(u32 a, u32 b) {
+    const u32 even = (((a & EVEN_BYTES) + (b & EVEN_BYTES)) >> 1) & EVEN_BYTES;
+    const u32 odd = ((((a >> 8) & EVEN_BYTES) + ((b >> 8) & EVEN_BYTES)) >> 1) & EVEN_BYTES;
+    return even | (odd << 8);
+}
+
+/// Averages the channels of four pixels, rounding down, with each channel in a 16-bit lane.
+constexpr u32 Average4(u32 a, u32 b, u32 c, u32 d) {
+    const u32 even_sum = (a & EVEN_BYTES) + (b & EVEN_BYTES) + (c & EVEN_BYTES) + (d & EVEN_BYTES);
+    const u32 odd_sum = ((a >> 8) & EVEN_BYTES) + ((b >> 8) & EVEN_BYTES) +
+                        ((c >> 8) & EVEN_BYTES) + ((d >> 8) & EVEN_BYTES);
+    return ((even_sum >> 2) & EVEN_BYTES) | (((odd_sum >> 2) & EVEN_BYTES) << 8);
+}
+
+/// Halves the width of a row by averaging horizontal pixel pairs.
+void HalveRow(const u32* row, u32* dest, u32 count) {
+    for (u32 x = 0; x < count; x++) {
+        dest[x] = Average2(row[2 * x], row[2 * x + 1]);
     }
 }
 
+/// Halves the size of two rows by averaging 2x2 pixel blocks.
+void QuarterRows(const u32* top, const u32* bottom, u32* dest, u32 count) {
+    for (u32 x = 0; x < count; x++) {
+        dest[x] = Average4(top[2 * x], top[2 * x + 1], bottom[2 * x], bottom[2 * x + 1]);
+    }
+}
+
+/**
+ * Copies a row of pixels between tiled and linear memory. The pixel pairs of a tile row are
+ * stored at morton indices 0, 4, 16 and 20 from the start of the row in the tile.
+ */
+template <bool untile>
+void CopyTiledRow(u8* tiled, u8* linear, u32 y, u32 count, u32 bytes_per_pixel, u32 stride) {
+    const auto copy = [](u8* tiled_pixel, u8* linear_pixel, u32 size) {
+        if constexpr (untile) {
+            std::memcpy(linear_pixel, tiled_pixel, size);
+        } else {
+            std::memcpy(tiled_pixel, linear_pixel, size);
+        }
+    };
+    u8* const row = tiled + (y & ~7) * stride;
+    const u32 pair_size = 2 * bytes_per_pixel;
+    u32 x = 0;
+    for (; x + 8 <= count; x += 8) {
+        u8* const tile = row + VideoCore::GetMortonOffset(x, y, bytes_per_pixel);
+        copy(tile, linear, pair_size);
+        copy(tile + 4 * bytes_per_pixel, linear + pair_size, pair_size);
+        copy(tile + 16 * bytes_per_pixel, linear + 2 * pair_size, pair_size);
+        copy(tile + 20 * bytes_per_pixel, linear + 3 * pair_size, pair_size);
+        linear += 4 * pair_size;
+    }
+    for (; x < count; x++) {
+        copy(row + VideoCore::GetMortonOffset(x, y, bytes_per_pixel), linear, bytes_per_pixel);
+        linear += bytes_per_pixel;
+    }
+}
+
+} // Anonymous namespace
+
 SwBlitter::SwBlitter(Memory::MemorySystem& memory_, VideoCore::RasterizerInterface* rasterizer_)
     : memory{memory_}, rasterizer{rasterizer_} {}
 
@@ -188,106 +375,64 @@ void SwBlitter::DisplayTransfer(const Pica::DisplayTransferConfig& config) {
     rasterizer->FlushRegion(config.GetPhysicalInputAddress(), input_size);
     rasterizer->InvalidateRegion(config.GetPhysicalOutputAddress(), output_size);
 
-    for (u32 y = 0; y < output_height; ++y) {
-        for (u32 x = 0; x < output_width; ++x) {
-            Common::Vec4<u8> src_color;
-
-            // Calculate the [x,y] position of the input image
-            // based on the current output position and the scale
-            const u32 input_x = x << horizontal_scale;
-            const u32 input_y = y << vertical_scale;
-
-            u32 output_y;
-            if (config.flip_vertically) {
-                // Flip the y value of the output data,
-                // we do this after calculating the [x,y] position of the input image
-                // to account for the scaling options.
-                output_y = output_height - y - 1;
-            } else {
-                output_y = y;
-            }
-
-            const u32 dst_bytes_per_pixel = BytesPerPixel(config.output_format);
-            const u32 src_bytes_per_pixel = BytesPerPixel(config.input_format);
-            u32 src_offset;
-            u32 dst_offset;
-
-            if (config.input_linear) {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as linear and the output as tiled
-                    u32 coarse_y = output_y & ~7;
-                    u32 stride = output_width * dst_bytes_per_pixel;
-
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 coarse_y * stride;
-                } else {
-                    // Both input and output are linear
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                }
-            } else {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as tiled and the output as linear
-                    const u32 coarse_y = input_y & ~7;
-                    const u32 stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 coarse_y * stride;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                } else {
-                    // Both input and output are tiled
-                    const u32 out_coarse_y = output_y & ~7;
-                    const u32 out_stride = output_width * dst_bytes_per_pixel;
-
-                    const u32 in_coarse_y = input_y & ~7;
-                    const u32 in_stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 in_coarse_y * in_stride;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 out_coarse_y * out_stride;
-                }
-            }
+    // Tiled input produces linear output and vice versa, unless swizzling is disabled.
+    const bool input_tiled = !config.input_linear;
+    const bool output_tiled = input_tiled == static_cast<bool>(config.dont_swizzle);
+    const u32 src_bytes_per_pixel = BytesPerPixel(config.input_format);
+    const u32 dst_bytes_per_pixel = BytesPerPixel(config.output_format);
+    const u32 src_stride = config.input_width * src_bytes_per_pixel;
+    const u32 dst_stride = output_width * dst_bytes_per_pixel;
+    const u32 input_row_width = output_width << horizontal_scale;
+
+    for (auto& row : input_rows) {
+        row.resize(input_row_width);
+    }
+    output_row.resize(output_width);
+    staging_row.resize(input_row_width * PIXEL_SIZE);
+
+    const auto load_row = [&](u32 input_y, std::vector<u32>& row) {
+        u8* const pixels = reinterpret_cast<u8*>(row.data());
+        if (!input_tiled) {
+            DecodeRow(config.input_format, src_pointer + input_y * src_stride, pixels,
+                      input_row_width);
+        } else if (config.input_format == Pica::PixelFormat::RGBA8) {
+            CopyTiledRow<true>(src_pointer, pixels, input_y, input_row_width, PIXEL_SIZE,
+                               src_stride);
+        } else {
+            CopyTiledRow<true>(src_pointer, staging_row.data(), input_y, input_row_width,
+                               src_bytes_per_pixel, src_stride);
+            DecodeRow(config.input_format, staging_row.data(), pixels, input_row_width);
+        }
+    };
 
-            const u8* src_pixel = src_pointer + src_offset;
-            src_color = DecodePixel(config.input_format, src_pixel);
-            if (config.scaling == config.ScaleX) {
-                const auto pixel =
-                    DecodePixel(config.input_format, src_pixel + src_bytes_per_pixel);
-                src_color = ((src_color + pixel) / 2).Cast<u8>();
-            } else if (config.scaling == config.ScaleXY) {
-                const auto pixel1 =
-                    DecodePixel(config.input_format, src_pixel + 1 * src_bytes_per_pixel);
-                const auto pixel2 =
-                    DecodePixel(config.input_format, src_pixel + 2 * src_bytes_per_pixel);
-                const auto pixel3 =
-                    DecodePixel(config.input_format, src_pixel + 3 * src_bytes_per_pixel);
-                src_color = (((src_color + pixel1) + (pixel2 + pixel3)) / 4).Cast<u8>();
-            }
+    for (u32 y = 0; y < output_height; ++y) {
+        // Calculate the row of the input image based on the current output row and the scale.
+        const u32 input_y = y << vertical_scale;
+
+        // Flip the y value of the output data, we do this after calculating the position of the
+        // input row to account for the scaling options.
+        const u32 output_y = config.flip_vertically ? output_height - y - 1 : y;
+
+        load_row(input_y, input_rows[0]);
+        const u32* pixels = input_rows[0].data();
+        if (config.scaling == config.ScaleX) {
+            HalveRow(input_rows[0].data(), output_row.data(), output_width);
+            pixels = output_row.data();
+        } else if (config.scaling == config.ScaleXY) {
+            load_row(input_y + 1, input_rows[1]);
+            QuarterRows(input_rows[0].data(), input_rows[1].data(), output_row.data(),
+                        output_width);
+            pixels = output_row.data();
+        }
 
-            u8* dst_pixel = dst_pointer + dst_offset;
-            switch (config.output_format) {
-            case Pica::PixelFormat::RGBA8:
-                Common::Color::EncodeRGBA8(src_color, dst_pixel);
-                break;
-            case Pica::PixelFormat::RGB8:
-                Common::Color::EncodeRGB8(src_color, dst_pixel);
-                break;
-            case Pica::PixelFormat::RGB565:
-                Common::Color::EncodeRGB565(src_color, dst_pixel);
-                break;
-            case Pica::PixelFormat::RGB5A1:
-                Common::Color::EncodeRGB5A1(src_color, dst_pixel);
-                break;
-            case Pica::PixelFormat::RGBA4:
-                Common::Color::EncodeRGBA4(src_color, dst_pixel);
-                break;
-            default:
-                LOG_ERROR(HW_GPU, "Unknown destination framebuffer format {:x}",
-                          static_cast<u32>(config.output_format.Value()));
-                break;
-            }
+        const u8* const encoded = reinterpret_cast<const u8*>(pixels);
+        if (!output_tiled) {
+            EncodeRow(config.output_format, encoded, dst_pointer + output_y * dst_stride,
+                      output_width);
+        } else {
+            EncodeRow(config.output_format, encoded, staging_row.data(), output_width);
+            CopyTiledRow<false>(dst_pointer, staging_row.data(), output_y, output_width,
+                                dst_bytes_per_pixel, dst_stride);
         }
     }
 }
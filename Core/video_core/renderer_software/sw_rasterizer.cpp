@@ -0,0 +1,1005 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include <boost/container/static_vector.hpp>
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "common/quaternion.h"
+#include "core/memory.h"
+#include "video_core/pica/pica_core.h"
+#include "video_core/renderer_software/sw_lighting.h"
+#include "video_core/renderer_software/sw_proctex.h"
+#include "video_core/renderer_software/sw_rasterizer.h"
+#include "video_core/renderer_software/sw_texturing.h"
+
+namespace SwRenderer {
+
+MICROPROFILE_DEFINE(GPU_Rasterization, "GPU", "Rasterization", MP_RGB(50, 50, 240));
+
+using Pica::f24;
+using Pica::FramebufferRegs;
+using Pica::RasterizerRegs;
+using Pica::TexturingRegs;
+using Pica::Texture::LookupTexture;
+using Pica::Texture::TextureInfo;
+
+namespace {
+
+/// Triangles in a batch below this count are rasterized on the calling thread.
+constexpr std::size_t MIN_PARALLEL_TRIANGLES = 4;
+
+struct Viewport {
+    f24 halfsize_x;
+    f24 offset_x;
+    f24 halfsize_y;
+    f24 offset_y;
+};
+
+/// Converts a screen space coordinate to 12.4 fixed point.
+s32 ToFixed12P4(f24 value) {
+    // Rounding here is necessary to prevent garbage pixels at triangle borders.
+    return static_cast<s32>(std::round(value.ToFloat32() * 16.0f));
+}
+
+s64 SignedArea(const Common::Vec2<s32>& vtx1, const Common::Vec2<s32>& vtx2,
+               const Common::Vec2<s32>& vtx3) {
+    return static_cast<s64>(vtx2.x - vtx1.x) * (vtx3.y - vtx1.y) -
+           static_cast<s64>(vtx2.y - vtx1.y) * (vtx3.x - vtx1.x);
+}
+
+/**
+ * Triangle filling rules: Pixels on the right-sided edge or on flat bottom edges are not
+ * drawn. Pixels on any other triangle border are drawn. This is implemented with three bias
+ * values which are added to the barycentric coordinates w0, w1 and w2, respectively.
+ */
+bool IsRightSideOrFlatBottomEdge(const Common::Vec2<s32>& vtx, const Common::Vec2<s32>& line1,
+                                 const Common::Vec2<s32>& line2) {
+    if (line1.y == line2.y) {
+        // Just check if vertex is above us => bottom line parallel to x-axis
+        return vtx.y < line1.y;
+    }
+    // Check if vertex is on our left => right side
+    return vtx.x < line1.x + static_cast<s32>(static_cast<s64>(line2.x - line1.x) *
+                                              (vtx.y - line1.y) / (line2.y - line1.y));
+}
+
+std::tuple<f24, f24, f24, PAddr> ConvertCubeCoord(f24 u, f24 v, f24 w,
+                                                  const TexturingRegs& regs) {
+    using CubeFace = TexturingRegs::CubeFace;
+    const float abs_u = std::abs(u.ToFloat32());
+    const float abs_v = std::abs(v.ToFloat32());
+    const float abs_w = std::abs(w.ToFloat32());
+    f24 x, y, z;
+    PAddr addr;
+    if (abs_u > abs_v && abs_u > abs_w) {
+        if (u > f24::Zero()) {
+            addr = regs.GetCubePhysicalAddress(CubeFace::PositiveX);
+            y = -v;
+        } else {
+            addr = regs.GetCubePhysicalAddress(CubeFace::NegativeX);
+            y = v;
+        }
+        x = -w;
+        z = u;
+    } else if (abs_v > abs_w) {
+        if (v > f24::Zero()) {
+            addr = regs.GetCubePhysicalAddress(CubeFace::PositiveY);
+            x = u;
+        } else {
+            addr = regs.GetCubePhysicalAddress(CubeFace::NegativeY);
+            x = -u;
+        }
+        y = w;
+        z = v;
+    } else {
+        if (w > f24::Zero()) {
+            addr = regs.GetCubePhysicalAddress(CubeFace::PositiveZ);
+            y = -v;
+        } else {
+            addr = regs.GetCubePhysicalAddress(CubeFace::NegativeZ);
+            y = v;
+        }
+        x = u;
+        z = w;
+    }
+    const f24 z_abs = f24::FromFloat32(std::abs(z.ToFloat32()));
+    const f24 half = f24::FromFloat32(0.5f);
+    return std::make_tuple(x / z * half + half, y / z * half + half, z_abs, addr);
+}
+
+} // Anonymous namespace
+
+RasterizerSoftware::RasterizerSoftware(Memory::MemorySystem& memory_, Pica::PicaCore& pica_)
+    : memory{memory_}, pica{pica_}, regs{pica.regs.internal},
+      num_sw_threads{std::max(std::thread::hardware_concurrency(), 2U)},
+      sw_workers{num_sw_threads, "SwRenderer workers"}, fb{memory, regs.framebuffer} {}
+
+RasterizerSoftware::~RasterizerSoftware() = default;
+
+void RasterizerSoftware::AddTriangle(const Pica::OutputVertex& v0, const Pica::OutputVertex& v1,
+                                     const Pica::OutputVertex& v2) {
+    /**
+     * Clipping a planar n-gon against a plane will remove at least 1 vertex and introduces 2 at
+     * the new edge (or less in degenerate cases). As such, we can say that each clipping plane
+     * introduces at most 1 new vertex to the polygon. Since we start with a triangle and have a
+     * fixed 7 clipping planes plus the optional user plane, the maximum number of vertices of the
+     * clipped polygon is 3 + 8 = 11.
+     **/
+    static constexpr std::size_t MAX_VERTICES = 11;
+
+    boost::container::static_vector<Vertex, MAX_VERTICES> buffer_a = {v0, v1, v2};
+    boost::container::static_vector<Vertex, MAX_VERTICES> buffer_b;
+
+    auto* output_list = &buffer_a;
+    auto* input_list = &buffer_b;
+
+    // NOTE: We clip against a w=epsilon plane to guarantee that the output has a positive w value.
+    // TODO: Not sure if this is a valid approach. Also should probably instead use the smallest
+    //       epsilon possible within f24 accuracy.
+    static const f24 EPSILON = f24::FromFloat32(0.00001f);
+    static const f24 f0 = f24::Zero();
+    static const f24 f1 = f24::One();
+    static const std::array<ClippingEdge, 7> clipping_edges = {{
+        {Common::MakeVec(-f1, f0, f0, f1)},                                         // x = +w
+        {Common::MakeVec(f1, f0, f0, f1)},                                          // x = -w
+        {Common::MakeVec(f0, -f1, f0, f1)},                                         // y = +w
+        {Common::MakeVec(f0, f1, f0, f1)},                                          // y = -w
+        {Common::MakeVec(f0, f0, -f1, f0)},                                         // z =  0
+        {Common::MakeVec(f0, f0, f1, f1)},                                          // z = -w
+        {Common::MakeVec(f0, f0, f0, f1), Common::Vec4<f24>(f0, f0, f0, EPSILON)}, // w = EPSILON
+    }};
+
+    // Simple implementation of the Sutherland-Hodgman clipping algorithm.
+    // TODO: Make this less inefficient (currently lots of useless buffering overhead happens here)
+    const auto clip = [&](const ClippingEdge& edge) {
+        std::swap(input_list, output_list);
+        output_list->clear();
+
+        const Vertex* reference_vertex = &input_list->back();
+        for (const auto& vertex : *input_list) {
+            // NOTE: This algorithm changes vertex order in some cases!
+            if (edge.IsInside(vertex)) {
+                if (edge.IsOutSide(*reference_vertex)) {
+                    output_list->push_back(edge.GetIntersection(vertex, *reference_vertex));
+                }
+                output_list->push_back(vertex);
+            } else if (edge.IsInside(*reference_vertex)) {
+                output_list->push_back(edge.GetIntersection(vertex, *reference_vertex));
+            }
+            reference_vertex = &vertex;
+        }
+    };
+
+    for (const ClippingEdge& edge : clipping_edges) {
+        clip(edge);
+        if (output_list->size() < 3) {
+            return;
+        }
+    }
+
+    if (regs.rasterizer.clip_enable) {
+        const ClippingEdge custom_edge{regs.rasterizer.GetClipCoef()};
+        clip(custom_edge);
+        if (output_list->size() < 3) {
+            return;
+        }
+    }
+
+    for (auto& vtx : *output_list) {
+        MakeScreenCoords(vtx);
+    }
+
+    for (std::size_t i = 0; i < output_list->size() - 2; i++) {
+        const Vertex& vtx0 = (*output_list)[0];
+        const Vertex& vtx1 = (*output_list)[i + 1];
+        const Vertex& vtx2 = (*output_list)[i + 2];
+        SetupTriangle(vtx0, vtx1, vtx2);
+    }
+}
+
+void RasterizerSoftware::MakeScreenCoords(Vertex& vtx) {
+    Viewport viewport{};
+    viewport.halfsize_x = f24::FromRaw(regs.rasterizer.viewport_size_x);
+    viewport.halfsize_y = f24::FromRaw(regs.rasterizer.viewport_size_y);
+    viewport.offset_x = f24::FromFloat32(static_cast<f32>(regs.rasterizer.viewport_corner.x));
+    viewport.offset_y = f24::FromFloat32(static_cast<f32>(regs.rasterizer.viewport_corner.y));
+
+    const f24 inv_w = f24::One() / vtx.pos.w;
+    vtx.pos.w = inv_w;
+    vtx.quat *= inv_w;
+    vtx.color *= inv_w;
+    vtx.tc0 *= inv_w;
+    vtx.tc1 *= inv_w;
+    vtx.tc0_w *= inv_w;
+    vtx.view *= inv_w;
+    vtx.tc2 *= inv_w;
+
+    vtx.screenpos[0] = (vtx.pos.x * inv_w + f24::One()) * viewport.halfsize_x + viewport.offset_x;
+    vtx.screenpos[1] = (vtx.pos.y * inv_w + f24::One()) * viewport.halfsize_y + viewport.offset_y;
+    vtx.screenpos[2] = vtx.pos.z * inv_w;
+}
+
+void RasterizerSoftware::SetupTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2) {
+    Triangle triangle{
+        .vtx = {v0, v1, v2},
+        .pos = {},
+        .bias = {},
+        .bounds = {},
+    };
+    for (u32 i = 0; i < 3; i++) {
+        triangle.pos[i] = Common::MakeVec(ToFixed12P4(triangle.vtx[i].screenpos[0]),
+                                          ToFixed12P4(triangle.vtx[i].screenpos[1]));
+    }
+
+    // Normalize all triangles to counter-clockwise winding, culling the ones facing away.
+    const auto cull_mode = regs.rasterizer.cull_mode.Value();
+    bool reverse = false;
+    if (cull_mode == RasterizerRegs::CullMode::KeepClockWise) {
+        reverse = true;
+    } else if (cull_mode == RasterizerRegs::CullMode::KeepAll) {
+        reverse = SignedArea(triangle.pos[0], triangle.pos[1], triangle.pos[2]) < 0;
+    }
+    if (reverse) {
+        std::swap(triangle.vtx[1], triangle.vtx[2]);
+        std::swap(triangle.pos[1], triangle.pos[2]);
+    }
+    const auto& [vtxpos0, vtxpos1, vtxpos2] = triangle.pos;
+    if (SignedArea(vtxpos0, vtxpos1, vtxpos2) <= 0) {
+        return;
+    }
+
+    s32 min_x = std::min({vtxpos0.x, vtxpos1.x, vtxpos2.x}) >> 4;
+    s32 min_y = std::min({vtxpos0.y, vtxpos1.y, vtxpos2.y}) >> 4;
+    s32 max_x = (std::max({vtxpos0.x, vtxpos1.x, vtxpos2.x}) + 0xF) >> 4;
+    s32 max_y = (std::max({vtxpos0.y, vtxpos1.y, vtxpos2.y}) + 0xF) >> 4;
+
+    // Convert the scissor box coordinates to pixel bounds. Exclude mode is handled per pixel.
+    const auto& scissor = regs.rasterizer.scissor_test;
+    if (scissor.mode == RasterizerRegs::ScissorMode::Include) {
+        min_x = std::max(min_x, static_cast<s32>(scissor.x1.Value()));
+        min_y = std::max(min_y, static_cast<s32>(scissor.y1.Value()));
+        max_x = std::min(max_x, static_cast<s32>(scissor.x2.Value()) + 1);
+        max_y = std::min(max_y, static_cast<s32>(scissor.y2.Value()) + 1);
+    }
+    if (min_x >= max_x || min_y >= max_y) {
+        return;
+    }
+
+    triangle.bias[0] = IsRightSideOrFlatBottomEdge(vtxpos0, vtxpos1, vtxpos2) ? -1 : 0;
+    triangle.bias[1] = IsRightSideOrFlatBottomEdge(vtxpos1, vtxpos2, vtxpos0) ? -1 : 0;
+    triangle.bias[2] = IsRightSideOrFlatBottomEdge(vtxpos2, vtxpos0, vtxpos1) ? -1 : 0;
+    triangle.bounds = Common::Rectangle<s32>{min_x, min_y, max_x, max_y};
+
+    triangles.push_back(std::move(triangle));
+}
+
+void RasterizerSoftware::DrawTriangles() {
+    if (triangles.empty()) {
+        return;
+    }
+
+    MICROPROFILE_SCOPE(GPU_Rasterization);
+
+    fb.Bind();
+    // Depth/stencil only passes still run, shadow maps are written to the color buffer.
+    if (!fb.HasColorBuffer() && (!fb.HasDepthBuffer() || regs.framebuffer.IsShadowRendering())) {
+        triangles.clear();
+        return;
+    }
+
+    // Bin the batch into screen tiles, each bin keeps its triangles in submission order.
+    const auto& framebuffer = regs.framebuffer.framebuffer;
+    const s32 width = static_cast<s32>(framebuffer.GetWidth());
+    const s32 height = static_cast<s32>(framebuffer.GetHeight());
+    const u32 tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+    const u32 tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+    tile_bins.resize(std::max<std::size_t>(tile_bins.size(), tiles_x * tiles_y));
+
+    for (u32 i = 0; i < triangles.size(); i++) {
+        const auto& bounds = triangles[i].bounds;
+        const s32 left = std::max(bounds.left, 0);
+        const s32 top = std::max(bounds.top, 0);
+        const s32 right = std::min(bounds.right, width);
+        const s32 bottom = std::min(bounds.bottom, height);
+        if (left >= right || top >= bottom) {
+            continue;
+        }
+        for (u32 ty = top / TILE_SIZE; ty <= (bottom - 1) / TILE_SIZE; ty++) {
+            for (u32 tx = left / TILE_SIZE; tx <= (right - 1) / TILE_SIZE; tx++) {
+                tile_bins[ty * tiles_x + tx].push_back(i);
+            }
+        }
+    }
+
+    const auto tile_rect = [&](u32 tile_index) {
+        const s32 x = static_cast<s32>((tile_index % tiles_x) * TILE_SIZE);
+        const s32 y = static_cast<s32>((tile_index / tiles_x) * TILE_SIZE);
+        return Common::Rectangle<s32>{x, y, std::min<s32>(x + TILE_SIZE, width),
+                                      std::min<s32>(y + TILE_SIZE, height)};
+    };
+
+    const bool parallel = triangles.size() >= MIN_PARALLEL_TRIANGLES;
+    for (u32 i = 0; i < tiles_x * tiles_y; i++) {
+        if (tile_bins[i].empty()) {
+            continue;
+        }
+        if (parallel) {
+            sw_workers.QueueWork(
+                [this, i, rect = tile_rect(i)] { RasterizeTile(tile_bins[i], rect); });
+        } else {
+            RasterizeTile(tile_bins[i], tile_rect(i));
+        }
+    }
+    if (parallel) {
+        sw_workers.WaitForRequests();
+    }
+
+    for (auto& bin : tile_bins) {
+        bin.clear();
+    }
+    triangles.clear();
+}
+
+void RasterizerSoftware::RasterizeTile(std::span<const u32> triangle_ids,
+                                       const Common::Rectangle<s32>& tile) const {
+    TextureUnits units;
+    const auto textures = regs.texturing.GetTextures();
+    for (u32 i = 0; i < textures.size(); i++) {
+        units.enabled[i] = textures[i].enabled != 0;
+        units.config[i] = textures[i].config;
+        units.info[i] = TextureInfo::FromPicaRegister(textures[i].config, textures[i].format);
+    }
+    const auto tev_stages = regs.texturing.GetTevStages();
+
+    for (const u32 id : triangle_ids) {
+        RasterizeTriangle(triangles[id], tile, units, tev_stages);
+    }
+}
+
+void RasterizerSoftware::RasterizeTriangle(
+    const Triangle& triangle, const Common::Rectangle<s32>& tile, const TextureUnits& units,
+    std::span<const TexturingRegs::TevStageConfig, 6> tev_stages) const {
+    const auto& [v0, v1, v2] = triangle.vtx;
+    const auto& [vtxpos0, vtxpos1, vtxpos2] = triangle.pos;
+
+    const s32 min_x = std::max(triangle.bounds.left, tile.left);
+    const s32 min_y = std::max(triangle.bounds.top, tile.top);
+    const s32 max_x = std::min(triangle.bounds.right, tile.right);
+    const s32 max_y = std::min(triangle.bounds.bottom, tile.bottom);
+
+    const auto& scissor = regs.rasterizer.scissor_test;
+    const bool scissor_exclude = scissor.mode == RasterizerRegs::ScissorMode::Exclude;
+
+    const auto w_inverse = Common::MakeVec(v0.pos.w, v1.pos.w, v2.pos.w);
+    const f24 depth_scale = f24::FromRaw(regs.rasterizer.viewport_depth_range);
+    const f24 depth_offset = f24::FromRaw(regs.rasterizer.viewport_depth_near_plane);
+    const bool shadow_rendering = regs.framebuffer.IsShadowRendering();
+    const bool color_write = regs.framebuffer.framebuffer.allow_color_write != 0 &&
+                             fb.HasColorBuffer();
+
+    for (s32 y = min_y; y < max_y; y++) {
+        for (s32 x = min_x; x < max_x; x++) {
+            if (scissor_exclude && x >= static_cast<s32>(scissor.x1.Value()) &&
+                x <= static_cast<s32>(scissor.x2.Value()) &&
+                y >= static_cast<s32>(scissor.y1.Value()) &&
+                y <= static_cast<s32>(scissor.y2.Value())) {
+                continue;
+            }
+
+            // Sample at the pixel center.
+            const Common::Vec2<s32> sample = Common::MakeVec((x << 4) + 8, (y << 4) + 8);
+            const s64 w0 = SignedArea(vtxpos1, vtxpos2, sample) + triangle.bias[0];
+            const s64 w1 = SignedArea(vtxpos2, vtxpos0, sample) + triangle.bias[1];
+            const s64 w2 = SignedArea(vtxpos0, vtxpos1, sample) + triangle.bias[2];
+            const s64 wsum = w0 + w1 + w2;
+
+            // If current pixel is not covered by the current primitive
+            if (w0 < 0 || w1 < 0 || w2 < 0) {
+                continue;
+            }
+
+            const auto baricentric_coordinates =
+                Common::MakeVec(f24::FromFloat32(static_cast<f32>(w0)),
+                                f24::FromFloat32(static_cast<f32>(w1)),
+                                f24::FromFloat32(static_cast<f32>(w2)));
+            const f24 interpolated_w_inverse =
+                f24::One() / Common::Dot(w_inverse, baricentric_coordinates);
+
+            // interpolated_z = z / w
+            const float interpolated_z_over_w =
+                (v0.screenpos[2].ToFloat32() * w0 + v1.screenpos[2].ToFloat32() * w1 +
+                 v2.screenpos[2].ToFloat32() * w2) /
+                wsum;
+
+            // Not fully accurate. About 3 bits in precision are missing.
+            // Z-Buffer (z / w * scale + offset)
+            float depth =
+                interpolated_z_over_w * depth_scale.ToFloat32() + depth_offset.ToFloat32();
+
+            // Potentially switch to W-Buffer
+            if (regs.rasterizer.depthmap_enable ==
+                Pica::RasterizerRegs::DepthBuffering::WBuffering) {
+                // W-Buffer (z * scale + w * offset = (z / w * scale + offset) * w)
+                depth *= interpolated_w_inverse.ToFloat32() * wsum;
+            }
+
+            // Clamp the result
+            depth = std::clamp(depth, 0.0f, 1.0f);
+
+            /**
+             * Perspective correct attribute interpolation:
+             * Attribute values cannot be calculated by simple linear interpolation since
+             * they are not linear in screen space. For example, when interpolating a
+             * texture coordinate across two vertices, something simple like
+             *     u = (u0*w0 + u1*w1)/(w0+w1)
+             * will not work. However, the attribute value divided by the
+             * clipspace w-coordinate (u/w) and and the inverse w-coordinate (1/w) are linear
+             * in screenspace. Hence, we can linearly interpolate these two independently and
+             * calculate the interpolated attribute by dividing the results.
+             * I.e.
+             *     u_over_w   = ((u0/v0.pos.w)*w0 + (u1/v1.pos.w)*w1)/(w0+w1)
+             *     one_over_w = (( 1/v0.pos.w)*w0 + ( 1/v1.pos.w)*w1)/(w0+w1)
+             *     u = u_over_w / one_over_w
+             *
+             * The generalization to three vertices is straightforward in baricentric
+             *coordinates.
+             **/
+            const auto get_interpolated_attribute = [&](f24 attr0, f24 attr1, f24 attr2) {
+                auto attr_over_w = Common::MakeVec(attr0, attr1, attr2);
+                f24 interpolated_attr_over_w = Common::Dot(attr_over_w, baricentric_coordinates);
+                return interpolated_attr_over_w * interpolated_w_inverse;
+            };
+
+            const Common::Vec4<u8> primary_color{
+                static_cast<u8>(std::round(
+                    get_interpolated_attribute(v0.color.r(), v1.color.r(), v2.color.r())
+                        .ToFloat32() *
+                    255)),
+                static_cast<u8>(std::round(
+                    get_interpolated_attribute(v0.color.g(), v1.color.g(), v2.color.g())
+                        .ToFloat32() *
+                    255)),
+                static_cast<u8>(std::round(
+                    get_interpolated_attribute(v0.color.b(), v1.color.b(), v2.color.b())
+                        .ToFloat32() *
+                    255)),
+                static_cast<u8>(std::round(
+                    get_interpolated_attribute(v0.color.a(), v1.color.a(), v2.color.a())
+                        .ToFloat32() *
+                    255)),
+            };
+
+            const std::array<Common::Vec2<f24>, 3> uv = {{
+                {get_interpolated_attribute(v0.tc0.u(), v1.tc0.u(), v2.tc0.u()),
+                 get_interpolated_attribute(v0.tc0.v(), v1.tc0.v(), v2.tc0.v())},
+                {get_interpolated_attribute(v0.tc1.u(), v1.tc1.u(), v2.tc1.u()),
+                 get_interpolated_attribute(v0.tc1.v(), v1.tc1.v(), v2.tc1.v())},
+                {get_interpolated_attribute(v0.tc2.u(), v1.tc2.u(), v2.tc2.u()),
+                 get_interpolated_attribute(v0.tc2.v(), v1.tc2.v(), v2.tc2.v())},
+            }};
+
+            // Sample bound texture units.
+            const f24 tc0_w = get_interpolated_attribute(v0.tc0_w, v1.tc0_w, v2.tc0_w);
+            const auto texture_color = TextureColor(uv, units, tc0_w);
+
+            Common::Vec4<u8> primary_fragment_color = {0, 0, 0, 0};
+            Common::Vec4<u8> secondary_fragment_color = {0, 0, 0, 0};
+            if (!regs.lighting.disable) {
+                const auto normquat =
+                    Common::Quaternion<f32>{
+                        {get_interpolated_attribute(v0.quat.x, v1.quat.x, v2.quat.x).ToFloat32(),
+                         get_interpolated_attribute(v0.quat.y, v1.quat.y, v2.quat.y).ToFloat32(),
+                         get_interpolated_attribute(v0.quat.z, v1.quat.z, v2.quat.z).ToFloat32()},
+                        get_interpolated_attribute(v0.quat.w, v1.quat.w, v2.quat.w).ToFloat32(),
+                    }
+                        .Normalized();
+
+                const Common::Vec3f view{
+                    get_interpolated_attribute(v0.view.x, v1.view.x, v2.view.x).ToFloat32(),
+                    get_interpolated_attribute(v0.view.y, v1.view.y, v2.view.y).ToFloat32(),
+                    get_interpolated_attribute(v0.view.z, v1.view.z, v2.view.z).ToFloat32(),
+                };
+                std::tie(primary_fragment_color, secondary_fragment_color) =
+                    ComputeFragmentsColors(regs.lighting, pica.lighting, normquat, view,
+                                           texture_color);
+            }
+
+            // Write the TEV stages.
+            auto combiner_output =
+                WriteTevConfig(texture_color, tev_stages, primary_color, primary_fragment_color,
+                               secondary_fragment_color);
+
+            if (shadow_rendering) {
+                const u32 depth_int = static_cast<u32>(depth * 0xFFFFFF);
+                // Use green color channel as the stencil value.
+                fb.DrawShadowMapPixel(x, y, depth_int, combiner_output.g());
+                continue;
+            }
+
+            if (!DoAlphaTest(combiner_output.a())) {
+                continue;
+            }
+            WriteFog(depth, combiner_output);
+            if (!DoDepthStencilTest(x, y, depth)) {
+                continue;
+            }
+            if (color_write) {
+                fb.DrawPixel(x, y, PixelColor(x, y, combiner_output));
+            }
+        }
+    }
+}
+
+std::array<Common::Vec4<u8>, 4> RasterizerSoftware::TextureColor(
+    std::span<const Common::Vec2<f24>, 3> uv, const TextureUnits& units, f24 tc0_w) const {
+    std::array<Common::Vec4<u8>, 4> texture_color{};
+    for (u32 i = 0; i < 3; ++i) {
+        const auto& config = units.config[i];
+        if (!units.enabled[i]) [[unlikely]] {
+            continue;
+        }
+        if (config.address == 0) [[unlikely]] {
+            texture_color[i] = {0, 0, 0, 0};
+            continue;
+        }
+
+        const s32 coordinate_i =
+            (i == 2 && regs.texturing.main_config.texture2_use_coord1) ? 1 : i;
+        f24 u = uv[coordinate_i].u();
+        f24 v = uv[coordinate_i].v();
+
+        // Only unit 0 respects the texturing type (according to 3DBrew)
+        PAddr texture_address = config.GetPhysicalAddress();
+        f24 shadow_z;
+        if (i == 0) {
+            switch (config.type) {
+            case TexturingRegs::TextureConfig::Texture2D:
+                break;
+            case TexturingRegs::TextureConfig::ShadowCube:
+            case TexturingRegs::TextureConfig::TextureCube: {
+                std::tie(u, v, shadow_z, texture_address) =
+                    ConvertCubeCoord(u, v, tc0_w, regs.texturing);
+                break;
+            }
+            case TexturingRegs::TextureConfig::Projection2D: {
+                u /= tc0_w;
+                v /= tc0_w;
+                break;
+            }
+            case TexturingRegs::TextureConfig::Shadow2D: {
+                if (!regs.texturing.shadow.orthographic) {
+                    u /= tc0_w;
+                    v /= tc0_w;
+                }
+                shadow_z = f24::FromFloat32(std::abs(tc0_w.ToFloat32()));
+                break;
+            }
+            case TexturingRegs::TextureConfig::Disabled:
+                continue; // skip this unit and continue to the next unit
+            default:
+                LOG_ERROR(Render_Software, "Unhandled texture type {:x}",
+                          static_cast<u32>(config.type.Value()));
+                UNIMPLEMENTED();
+                break;
+            }
+        }
+
+        const f24 width = f24::FromFloat32(static_cast<f32>(config.width));
+        const f24 height = f24::FromFloat32(static_cast<f32>(config.height));
+        const s32 s = static_cast<s32>((u * width).ToFloat32());
+        const s32 t = static_cast<s32>((v * height).ToFloat32());
+
+        bool use_border_s = false;
+        bool use_border_t = false;
+
+        if (config.wrap_s == TexturingRegs::TextureConfig::ClampToBorder) {
+            use_border_s = s < 0 || s >= static_cast<s32>(config.width);
+        } else if (config.wrap_s == TexturingRegs::TextureConfig::ClampToBorder2) {
+            use_border_s = s >= static_cast<s32>(config.width);
+        }
+
+        if (config.wrap_t == TexturingRegs::TextureConfig::ClampToBorder) {
+            use_border_t = t < 0 || t >= static_cast<s32>(config.height);
+        } else if (config.wrap_t == TexturingRegs::TextureConfig::ClampToBorder2) {
+            use_border_t = t >= static_cast<s32>(config.height);
+        }
+
+        if (use_border_s || use_border_t) {
+            const auto border_color = config.border_color;
+            texture_color[i] = Common::MakeVec(border_color.r.Value(), border_color.g.Value(),
+                                               border_color.b.Value(), border_color.a.Value())
+                                   .Cast<u8>();
+        } else {
+            // Textures are laid out from bottom to top, hence we invert the t coordinate.
+            // NOTE: This may not be the right place for the inversion.
+            // TODO: Check if this applies to ETC textures, too.
+            const s32 coord_s = GetWrappedTexCoord(config.wrap_s, s, config.width);
+            const s32 coord_t =
+                config.height - 1 - GetWrappedTexCoord(config.wrap_t, t, config.height);
+
+            const u8* texture_data = memory.GetPhysicalPointer(texture_address);
+            if (!texture_data) [[unlikely]] {
+                texture_color[i] = {0, 0, 0, 0};
+                continue;
+            }
+
+            // TODO: Apply the min and mag filters to the texture
+            texture_color[i] = LookupTexture(texture_data, coord_s, coord_t, units.info[i]);
+        }
+
+        if (i == 0 && (config.type == TexturingRegs::TextureConfig::Shadow2D ||
+                       config.type == TexturingRegs::TextureConfig::ShadowCube)) {
+
+            s32 z_int = static_cast<s32>(std::min(shadow_z.ToFloat32(), 1.0f) * 0xFFFFFF);
+            z_int -= regs.texturing.shadow.bias << 1;
+            const auto& color = texture_color[i];
+            const s32 z_ref = (color.w << 16) | (color.z << 8) | color.y;
+            const u8 density = z_ref >= z_int ? color.x : 0;
+            texture_color[i] = {density, density, density, density};
+        }
+    }
+
+    // Sample procedural texture
+    if (regs.texturing.main_config.texture3_enable) {
+        const auto& proctex_uv = uv[regs.texturing.main_config.texture3_coordinates];
+        texture_color[3] = ProcTex(proctex_uv.u().ToFloat32(), proctex_uv.v().ToFloat32(),
+                                   regs.texturing, pica.proctex);
+    }
+
+    return texture_color;
+}
+
+Common::Vec4<u8> RasterizerSoftware::WriteTevConfig(
+    std::span<const Common::Vec4<u8>, 4> texture_color,
+    std::span<const TexturingRegs::TevStageConfig, 6> tev_stages,
+    Common::Vec4<u8> primary_color, Common::Vec4<u8> primary_fragment_color,
+    Common::Vec4<u8> secondary_fragment_color) const {
+    /**
+     * Texture environment - consists of 6 stages of color and alpha combining.
+     * Color combiners take three input color values from some source (e.g. interpolated
+     * vertex color, texture color, previous stage, etc), perform some very simple
+     * operations on each of them (e.g. inversion) and then calculate the output color
+     * with some basic arithmetic. Alpha combiners can be configured separately but work
+     * analogously.
+     **/
+    Common::Vec4<u8> combiner_output = primary_color;
+    Common::Vec4<u8> combiner_buffer = {0, 0, 0, 0};
+    Common::Vec4<u8> next_combiner_buffer =
+        Common::MakeVec(regs.texturing.tev_combiner_buffer_color.r.Value(),
+                        regs.texturing.tev_combiner_buffer_color.g.Value(),
+                        regs.texturing.tev_combiner_buffer_color.b.Value(),
+                        regs.texturing.tev_combiner_buffer_color.a.Value())
+            .Cast<u8>();
+
+    for (u32 tev_stage_index = 0; tev_stage_index < tev_stages.size(); ++tev_stage_index) {
+        const auto& tev_stage = tev_stages[tev_stage_index];
+        using Source = TexturingRegs::TevStageConfig::Source;
+
+        auto get_source = [&](Source source) -> Common::Vec4<u8> {
+            switch (source) {
+            case Source::PrimaryColor:
+                return primary_color;
+            case Source::PrimaryFragmentColor:
+                return primary_fragment_color;
+            case Source::SecondaryFragmentColor:
+                return secondary_fragment_color;
+            case Source::Texture0:
+                return texture_color[0];
+            case Source::Texture1:
+                return texture_color[1];
+            case Source::Texture2:
+                return texture_color[2];
+            case Source::Texture3:
+                return texture_color[3];
+            case Source::PreviousBuffer:
+                return combiner_buffer;
+            case Source::Constant:
+                return Common::MakeVec(tev_stage.const_r.Value(), tev_stage.const_g.Value(),
+                                       tev_stage.const_b.Value(), tev_stage.const_a.Value())
+                    .Cast<u8>();
+            case Source::Previous:
+                return combiner_output;
+            default:
+                LOG_ERROR(Render_Software, "Unknown color combiner source {}",
+                          static_cast<u32>(source));
+                UNIMPLEMENTED();
+                return {0, 0, 0, 0};
+            }
+        };
+
+        /**
+         * Color combiner
+         * NOTE: Not sure if the alpha combiner might use the color output of the previous
+         *       stage as input. Hence, we currently don't directly write the result to
+         *       combiner_output.rgb(), but instead store it in a temporary variable until
+         *       alpha combining has been done.
+         **/
+        const std::array<Common::Vec3<u8>, 3> color_result = {
+            GetColorModifier(tev_stage.color_modifier1, get_source(tev_stage.color_source1)),
+            GetColorModifier(tev_stage.color_modifier2, get_source(tev_stage.color_source2)),
+            GetColorModifier(tev_stage.color_modifier3, get_source(tev_stage.color_source3)),
+        };
+        const Common::Vec3<u8> color_output = ColorCombine(tev_stage.color_op, color_result);
+
+        u8 alpha_output;
+        if (tev_stage.color_op == TexturingRegs::TevStageConfig::Operation::Dot3_RGBA) {
+            // result of Dot3_RGBA operation is also placed to the alpha component
+            alpha_output = color_output.x;
+        } else {
+            // alpha combiner
+            const std::array<u8, 3> alpha_result = {{
+                GetAlphaModifier(tev_stage.alpha_modifier1, get_source(tev_stage.alpha_source1)),
+                GetAlphaModifier(tev_stage.alpha_modifier2, get_source(tev_stage.alpha_source2)),
+                GetAlphaModifier(tev_stage.alpha_modifier3, get_source(tev_stage.alpha_source3)),
+            }};
+            alpha_output = AlphaCombine(tev_stage.alpha_op, alpha_result);
+        }
+
+        combiner_output[0] = static_cast<u8>(
+            std::min(255U, color_output.r() * tev_stage.GetColorMultiplier()));
+        combiner_output[1] = static_cast<u8>(
+            std::min(255U, color_output.g() * tev_stage.GetColorMultiplier()));
+        combiner_output[2] = static_cast<u8>(
+            std::min(255U, color_output.b() * tev_stage.GetColorMultiplier()));
+        combiner_output[3] =
+            static_cast<u8>(std::min(255U, alpha_output * tev_stage.GetAlphaMultiplier()));
+
+        combiner_buffer = next_combiner_buffer;
+
+        if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferColor(
+                tev_stage_index)) {
+            next_combiner_buffer.r() = combiner_output.r();
+            next_combiner_buffer.g() = combiner_output.g();
+            next_combiner_buffer.b() = combiner_output.b();
+        }
+
+        if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferAlpha(
+                tev_stage_index)) {
+            next_combiner_buffer.a() = combiner_output.a();
+        }
+    }
+
+    return combiner_output;
+}
+
+void RasterizerSoftware::WriteFog(float depth, Common::Vec4<u8>& combiner_output) const {
+    /**
+     * Apply fog combiner. Not fully accurate. We'd have to know what data type is used to
+     * store the depth etc. Using float for now until we know more about Pica datatypes.
+     **/
+    if (regs.texturing.fog_mode != TexturingRegs::FogMode::Fog) {
+        return;
+    }
+
+    const Common::Vec3<u8> fog_color =
+        Common::MakeVec(regs.texturing.fog_color.r.Value(), regs.texturing.fog_color.g.Value(),
+                        regs.texturing.fog_color.b.Value())
+            .Cast<u8>();
+
+    // Get index into fog LUT
+    float fog_index;
+    if (regs.texturing.fog_flip) {
+        fog_index = (1.0f - depth) * 128.0f;
+    } else {
+        fog_index = depth * 128.0f;
+    }
+
+    // Generate clamped fog factor from LUT for given fog index
+    const f32 fog_i = std::clamp(std::floor(fog_index), 0.0f, 127.0f);
+    const f32 fog_f = fog_index - fog_i;
+    const auto& fog_lut_entry = pica.fog.lut[static_cast<u32>(fog_i)];
+    f32 fog_factor = fog_lut_entry.ToFloat() + fog_lut_entry.DiffToFloat() * fog_f;
+    fog_factor = std::clamp(fog_factor, 0.0f, 1.0f);
+
+    // Blend the fog
+    for (u32 i = 0; i < 3; i++) {
+        combiner_output[i] = static_cast<u8>(fog_factor * combiner_output[i] +
+                                             (1.0f - fog_factor) * fog_color[i]);
+    }
+}
+
+bool RasterizerSoftware::DoAlphaTest(u8 alpha) const {
+    const auto& output_merger = regs.framebuffer.output_merger;
+    if (!output_merger.alpha_test.enable) {
+        return true;
+    }
+
+    switch (output_merger.alpha_test.func) {
+    case FramebufferRegs::CompareFunc::Never:
+        return false;
+    case FramebufferRegs::CompareFunc::Always:
+        return true;
+    case FramebufferRegs::CompareFunc::Equal:
+        return alpha == output_merger.alpha_test.ref;
+    case FramebufferRegs::CompareFunc::NotEqual:
+        return alpha != output_merger.alpha_test.ref;
+    case FramebufferRegs::CompareFunc::LessThan:
+        return alpha < output_merger.alpha_test.ref;
+    case FramebufferRegs::CompareFunc::LessThanOrEqual:
+        return alpha <= output_merger.alpha_test.ref;
+    case FramebufferRegs::CompareFunc::GreaterThan:
+        return alpha > output_merger.alpha_test.ref;
+    case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
+        return alpha >= output_merger.alpha_test.ref;
+    default:
+        LOG_CRITICAL(Render_Software, "Unknown alpha test condition {}",
+                     static_cast<u32>(output_merger.alpha_test.func.Value()));
+        return false;
+    }
+}
+
+bool RasterizerSoftware::DoDepthStencilTest(u32 x, u32 y, float depth) const {
+    if (!fb.HasDepthBuffer()) {
+        return true;
+    }
+
+    const auto& framebuffer = regs.framebuffer.framebuffer;
+    const auto stencil_test = regs.framebuffer.output_merger.stencil_test;
+    u8 old_stencil = 0;
+
+    const auto update_stencil = [&](FramebufferRegs::StencilAction action) {
+        const u8 new_stencil =
+            PerformStencilAction(action, old_stencil, stencil_test.reference_value);
+        if (framebuffer.allow_depth_stencil_write != 0) {
+            const u8 stencil = (new_stencil & stencil_test.write_mask) |
+                               (old_stencil & ~stencil_test.write_mask);
+            fb.SetStencil(x, y, stencil);
+        }
+    };
+
+    const bool stencil_action_enable =
+        regs.framebuffer.output_merger.stencil_test.enable && regs.framebuffer.HasStencil();
+
+    const auto compare = [](FramebufferRegs::CompareFunc func, u32 lhs, u32 rhs) {
+        switch (func) {
+        case FramebufferRegs::CompareFunc::Never:
+            return false;
+        case FramebufferRegs::CompareFunc::Always:
+            return true;
+        case FramebufferRegs::CompareFunc::Equal:
+            return lhs == rhs;
+        case FramebufferRegs::CompareFunc::NotEqual:
+            return lhs != rhs;
+        case FramebufferRegs::CompareFunc::LessThan:
+            return lhs < rhs;
+        case FramebufferRegs::CompareFunc::LessThanOrEqual:
+            return lhs <= rhs;
+        case FramebufferRegs::CompareFunc::GreaterThan:
+            return lhs > rhs;
+        case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
+            return lhs >= rhs;
+        }
+        return false;
+    };
+
+    if (stencil_action_enable) {
+        old_stencil = fb.GetStencil(x, y);
+        const u8 dest = old_stencil & stencil_test.input_mask;
+        const u8 ref = stencil_test.reference_value & stencil_test.input_mask;
+        if (!compare(stencil_test.func, ref, dest)) {
+            update_stencil(stencil_test.action_stencil_fail);
+            return false;
+        }
+    }
+
+    const u32 num_bits = FramebufferRegs::DepthBitsPerPixel(framebuffer.depth_format);
+    const u32 z = static_cast<u32>(depth * ((1 << num_bits) - 1));
+
+    const auto& output_merger = regs.framebuffer.output_merger;
+    if (output_merger.depth_test_enable) {
+        const u32 ref_z = fb.GetDepth(x, y);
+        if (!compare(output_merger.depth_test_func, z, ref_z)) {
+            if (stencil_action_enable) {
+                update_stencil(stencil_test.action_depth_fail);
+            }
+            return false;
+        }
+    }
+
+    if (framebuffer.allow_depth_stencil_write != 0 && output_merger.depth_write_enable) {
+        fb.SetDepth(x, y, z);
+    }
+
+    // The stencil depth_pass action is executed even if depth testing is disabled
+    if (stencil_action_enable) {
+        update_stencil(stencil_test.action_depth_pass);
+    }
+
+    return true;
+}
+
+Common::Vec4<u8> RasterizerSoftware::PixelColor(u32 x, u32 y,
+                                                const Common::Vec4<u8>& combiner_output) const {
+    const auto dest = fb.GetPixel(x, y);
+    Common::Vec4<u8> blend_output = combiner_output;
+
+    const auto& output_merger = regs.framebuffer.output_merger;
+    if (output_merger.alphablend_enable) {
+        const auto params = output_merger.alpha_blending;
+        const Common::Vec4<u8> blend_const =
+            Common::MakeVec(
+                output_merger.blend_const.r.Value(), output_merger.blend_const.g.Value(),
+                output_merger.blend_const.b.Value(), output_merger.blend_const.a.Value())
+                .Cast<u8>();
+
+        const auto lookup_factor = [&](u32 channel, FramebufferRegs::BlendFactor factor) -> u8 {
+            DEBUG_ASSERT(channel < 4);
+            switch (factor) {
+            case FramebufferRegs::BlendFactor::Zero:
+                return 0;
+            case FramebufferRegs::BlendFactor::One:
+                return 255;
+            case FramebufferRegs::BlendFactor::SourceColor:
+                return combiner_output[channel];
+            case FramebufferRegs::BlendFactor::OneMinusSourceColor:
+                return 255 - combiner_output[channel];
+            case FramebufferRegs::BlendFactor::DestColor:
+                return dest[channel];
+            case FramebufferRegs::BlendFactor::OneMinusDestColor:
+                return 255 - dest[channel];
+            case FramebufferRegs::BlendFactor::SourceAlpha:
+                return combiner_output.a();
+            case FramebufferRegs::BlendFactor::OneMinusSourceAlpha:
+                return 255 - combiner_output.a();
+            case FramebufferRegs::BlendFactor::DestAlpha:
+                return dest.a();
+            case FramebufferRegs::BlendFactor::OneMinusDestAlpha:
+                return 255 - dest.a();
+            case FramebufferRegs::BlendFactor::ConstantColor:
+                return blend_const[channel];
+            case FramebufferRegs::BlendFactor::OneMinusConstantColor:
+                return 255 - blend_const[channel];
+            case FramebufferRegs::BlendFactor::ConstantAlpha:
+                return blend_const.a();
+            case FramebufferRegs::BlendFactor::OneMinusConstantAlpha:
+                return 255 - blend_const.a();
+            case FramebufferRegs::BlendFactor::SourceAlphaSaturate:
+                // Returns 1.0 for the alpha channel
+                if (channel == 3) {
+                    return 255;
+                }
+                return std::min(combiner_output.a(), static_cast<u8>(255 - dest.a()));
+            default:
+                LOG_CRITICAL(Render_Software, "Unknown blend factor {:x}",
+                             static_cast<u32>(factor));
+                UNIMPLEMENTED();
+                break;
+            }
+            return combiner_output[channel];
+        };
+
+        const auto srcfactor = Common::MakeVec(
+            lookup_factor(0, params.factor_source_rgb), lookup_factor(1, params.factor_source_rgb),
+            lookup_factor(2, params.factor_source_rgb), lookup_factor(3, params.factor_source_a));
+
+        const auto dstfactor = Common::MakeVec(
+            lookup_factor(0, params.factor_dest_rgb), lookup_factor(1, params.factor_dest_rgb),
+            lookup_factor(2, params.factor_dest_rgb), lookup_factor(3, params.factor_dest_a));
+
+        blend_output = EvaluateBlendEquation(combiner_output, srcfactor, dest, dstfactor,
+                                             params.blend_equation_rgb);
+        blend_output.a() = EvaluateBlendEquation(combiner_output, srcfactor, dest, dstfactor,
+                                                 params.blend_equation_a)
+                               .a();
+    } else {
+        blend_output =
+            Common::MakeVec(LogicOp(combiner_output.r(), dest.r(), output_merger.logic_op),
+                            LogicOp(combiner_output.g(), dest.g(), output_merger.logic_op),
+                            LogicOp(combiner_output.b(), dest.b(), output_merger.logic_op),
+                            LogicOp(combiner_output.a(), dest.a(), output_merger.logic_op));
+    }
+
+    const Common::Vec4<u8> result = {
+        output_merger.red_enable ? blend_output.r() : dest.r(),
+        output_merger.green_enable ? blend_output.g() : dest.g(),
+        output_merger.blue_enable ? blend_output.b() : dest.b(),
+        output_merger.alpha_enable ? blend_output.a() : dest.a(),
+    };
+
+    return result;
+}
+
+} // namespace SwRenderer
@@ -0,0 +1,195 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "video_core/renderer_software/sw_texturing.h"
+
+namespace SwRenderer {
+
+using TexturingRegs = Pica::TexturingRegs;
+
+int GetWrappedTexCoord(TexturingRegs::TextureConfig::WrapMode mode, s32 val, u32 size) {
+    switch (mode) {
+    case TexturingRegs::TextureConfig::ClampToEdge2:
+        // For negative coordinate, ClampToEdge2 behaves the same as Repeat
+        if (val < 0) {
+            return static_cast<s32>(static_cast<u32>(val) % size);
+        }
+        [[fallthrough]];
+    case TexturingRegs::TextureConfig::ClampToEdge:
+        val = std::max(val, 0);
+        val = std::min(val, static_cast<s32>(size) - 1);
+        return val;
+    case TexturingRegs::TextureConfig::ClampToBorder:
+        return val;
+    case TexturingRegs::TextureConfig::ClampToBorder2:
+    // For ClampToBorder2, the case of positive coordinate beyond the texture size is already
+    // handled outside. Here we only handle the negative coordinate in the same way as Repeat.
+    case TexturingRegs::TextureConfig::Repeat2:
+    case TexturingRegs::TextureConfig::Repeat3:
+    case TexturingRegs::TextureConfig::Repeat:
+        return static_cast<s32>(static_cast<u32>(val) % size);
+    case TexturingRegs::TextureConfig::MirroredRepeat: {
+        u32 coord = (static_cast<u32>(val) % (2 * size));
+        if (coord >= size) {
+            coord = 2 * size - 1 - coord;
+        }
+        return static_cast<s32>(coord);
+    }
+    default:
+        LOG_ERROR(Render_Software, "Unknown texture coordinate wrapping mode {:x}",
+                  static_cast<u32>(mode));
+        UNIMPLEMENTED();
+        return 0;
+    }
+};
+
+Common::Vec3<u8> GetColorModifier(TevStageConfig::ColorModifier factor,
+                                  const Common::Vec4<u8>& values) {
+    using ColorModifier = TevStageConfig::ColorModifier;
+    const auto invert = [](const Common::Vec3<u8>& v) {
+        return Common::MakeVec<u8>(255 - v.r(), 255 - v.g(), 255 - v.b());
+    };
+
+    switch (factor) {
+    case ColorModifier::SourceColor:
+        return values.rgb();
+    case ColorModifier::OneMinusSourceColor:
+        return invert(values.rgb());
+    case ColorModifier::SourceAlpha:
+        return values.aaa();
+    case ColorModifier::OneMinusSourceAlpha:
+        return invert(values.aaa());
+    case ColorModifier::SourceRed:
+        return values.rrr();
+    case ColorModifier::OneMinusSourceRed:
+        return invert(values.rrr());
+    case ColorModifier::SourceGreen:
+        return values.ggg();
+    case ColorModifier::OneMinusSourceGreen:
+        return invert(values.ggg());
+    case ColorModifier::SourceBlue:
+        return values.bbb();
+    case ColorModifier::OneMinusSourceBlue:
+        return invert(values.bbb());
+    default:
+        LOG_ERROR(Render_Software, "Unknown color factor {}", static_cast<u32>(factor));
+        UNIMPLEMENTED();
+        return {0, 0, 0};
+    }
+};
+
+u8 GetAlphaModifier(TevStageConfig::AlphaModifier factor, const Common::Vec4<u8>& values) {
+    using AlphaModifier = TevStageConfig::AlphaModifier;
+    switch (factor) {
+    case AlphaModifier::SourceAlpha:
+        return values.a();
+    case AlphaModifier::OneMinusSourceAlpha:
+        return 255 - values.a();
+    case AlphaModifier::SourceRed:
+        return values.r();
+    case AlphaModifier::OneMinusSourceRed:
+        return 255 - values.r();
+    case AlphaModifier::SourceGreen:
+        return values.g();
+    case AlphaModifier::OneMinusSourceGreen:
+        return 255 - values.g();
+    case AlphaModifier::SourceBlue:
+        return values.b();
+    case AlphaModifier::OneMinusSourceBlue:
+        return 255 - values.b();
+    default:
+        LOG_ERROR(Render_Software, "Unknown alpha factor {}", static_cast<u32>(factor));
+        UNIMPLEMENTED();
+        return 0;
+    }
+};
+
+Common::Vec3<u8> ColorCombine(TevStageConfig::Operation op,
+                              std::span<const Common::Vec3<u8>, 3> input) {
+    using Operation = TevStageConfig::Operation;
+    const auto saturate = [](const Common::Vec3<int>& v) {
+        return Common::MakeVec<u8>(static_cast<u8>(std::clamp(v.r(), 0, 255)),
+                                   static_cast<u8>(std::clamp(v.g(), 0, 255)),
+                                   static_cast<u8>(std::clamp(v.b(), 0, 255)));
+    };
+
+    switch (op) {
+    case Operation::Replace:
+        return input[0];
+    case Operation::Modulate:
+        return ((input[0] * input[1]) / 255).Cast<u8>();
+    case Operation::Add:
+        return saturate(input[0].Cast<int>() + input[1].Cast<int>());
+    case Operation::AddSigned:
+        // TODO(bunnei): Verify that the color conversion from (float) 0.5f to
+        // (byte) 128 is correct
+        return saturate(input[0].Cast<int>() + input[1].Cast<int>() -
+                        Common::MakeVec<int>(128, 128, 128));
+    case Operation::Lerp: {
+        const auto inv = Common::MakeVec<int>(255, 255, 255) - input[2].Cast<int>();
+        return ((input[0].Cast<int>() * input[2].Cast<int>() + input[1].Cast<int>() * inv) / 255)
+            .Cast<u8>();
+    }
+    case Operation::Subtract:
+        return saturate(input[0].Cast<int>() - input[1].Cast<int>());
+    case Operation::MultiplyThenAdd:
+        return saturate((input[0].Cast<int>() * input[1].Cast<int>() +
+                         input[2].Cast<int>() * 255) /
+                        255);
+    case Operation::AddThenMultiply: {
+        const auto sum = saturate(input[0].Cast<int>() + input[1].Cast<int>());
+        return ((sum.Cast<int>() * input[2].Cast<int>()) / 255).Cast<u8>();
+    }
+    case Operation::Dot3_RGB:
+    case Operation::Dot3_RGBA: {
+        // Not fully accurate.  Worst case scenario seems to yield a +/-3 error.  Some HW results
+        // indicate that the per-component computation can't have a higher precision than 1/256,
+        // while dot3_rgb((0x80,g0,b0), (0x7F,g1,b1)) and dot3_rgb((0x80,g0,b0), (0x80,g1,b1)) give
+        // different results.
+        int result = ((input[0].r() * 2 - 255) * (input[1].r() * 2 - 255) + 128) / 256 +
+                     ((input[0].g() * 2 - 255) * (input[1].g() * 2 - 255) + 128) / 256 +
+                     ((input[0].b() * 2 - 255) * (input[1].b() * 2 - 255) + 128) / 256;
+        const u8 value = static_cast<u8>(std::clamp(result, 0, 255));
+        return {value, value, value};
+    }
+    default:
+        LOG_ERROR(Render_Software, "Unknown color combiner operation {}", static_cast<u32>(op));
+        UNIMPLEMENTED();
+        return {0, 0, 0};
+    }
+};
+
+u8 AlphaCombine(TevStageConfig::Operation op, const std::array<u8, 3>& input) {
+    switch (op) {
+        using Operation = TevStageConfig::Operation;
+    case Operation::Replace:
+        return input[0];
+    case Operation::Modulate:
+        return input[0] * input[1] / 255;
+    case Operation::Add:
+        return static_cast<u8>(std::min(255, input[0] + input[1]));
+    case Operation::AddSigned: {
+        // TODO(bunnei): Verify that the color conversion from (float) 0.5f to (byte) 128 is correct
+        const int result = static_cast<int>(input[0]) + static_cast<int>(input[1]) - 128;
+        return static_cast<u8>(std::clamp<int>(result, 0, 255));
+    }
+    case Operation::Lerp:
+        return (input[0] * input[2] + input[1] * (255 - input[2])) / 255;
+    case Operation::Subtract:
+        return static_cast<u8>(std::max(0, static_cast<int>(input[0]) - input[1]));
+    case Operation::MultiplyThenAdd:
+        return static_cast<u8>(std::min(255, (input[0] * input[1] + 255 * input[2]) / 255));
+    case Operation::AddThenMultiply:
+        return (std::min(255, (input[0] + input[1])) * input[2]) / 255;
+    default:
+        LOG_ERROR(Render_Software, "Unknown alpha combiner operation {}", static_cast<u32>(op));
+        UNIMPLEMENTED();
+        return 0;
+    }
+};
+
+} // namespace SwRenderer
@@ -167,6 +167,18 @@ void StreamBuffer::Commit(u32 size) {
     watch.tick = scheduler.CurrentTick();
 }
 
+void StreamBuffer::Invalidate(u32 region_offset, u32 size) {
+    if (is_coherent) {
+        return;
+    }
+    const vk::MappedMemoryRange range = {
+        .memory = memory,
+        .offset = region_offset,
+        .size = size,
+    };
+    device.invalidateMappedMemoryRanges(range);
+}
+
 void StreamBuffer::CreateBuffers(u64 prefered_size) {
     const vk::Device device = instance.GetDevice();
     const auto memory_properties = instance.GetPhysicalDevice().getMemoryProperties();
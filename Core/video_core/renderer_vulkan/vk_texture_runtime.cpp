@@ -7,7 +7,6 @@
 
 #include "common/literals.h"
 #include "common/microprofile.h"
-#include "common/scope_exit.h"
 #include "video_core/custom_textures/material.h"
 #include "video_core/rasterizer_cache/texture_codec.h"
 #include "video_core/rasterizer_cache/utils.h"
@@ -280,6 +279,15 @@ void TextureRuntime::Finish() {
     scheduler.Finish();
 }
 
+void TextureRuntime::Flush() {
+    scheduler.Flush();
+}
+
+void TextureRuntime::WaitDownload(u64 tick, const VideoCore::StagingData& staging) {
+    scheduler.Wait(tick);
+    download_buffer.Invalidate(staging.offset, staging.size);
+}
+
 bool TextureRuntime::Reinterpret(Surface& source, Surface& dest,
                                  const VideoCore::TextureCopy& copy) {
     const PixelFormat src_format = source.pixel_format;
@@ -967,11 +975,19 @@ void Surface::UploadCustom(const VideoCore::Material* material, u32 level) {
 
 void Surface::Download(const VideoCore::BufferTextureCopy& download,
                        const VideoCore::StagingData& staging) {
-    SCOPE_EXIT({
-        scheduler->Finish();
-        runtime->download_buffer.Commit(staging.size);
-    });
+    RecordDownload(download);
+    scheduler->Finish();
+    runtime->download_buffer.Commit(staging.size);
+}
+
+u64 Surface::DownloadAsync(const VideoCore::BufferTextureCopy& download,
+                           const VideoCore::StagingData& staging) {
+    RecordDownload(download);
+    runtime->download_buffer.Commit(staging.size);
+    return scheduler->CurrentTick();
+}
 
+void Surface::RecordDownload(const VideoCore::BufferTextureCopy& download) {
     runtime->renderpass_cache.EndRendering();
 
     if (pixel_format == PixelFormat::D24S8) {
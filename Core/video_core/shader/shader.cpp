@@ -7,10 +7,17 @@
 #if CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
 #include "video_core/shader/shader_jit.h"
 #endif
+#include "video_core/pica/shader_unit.h"
 #include "video_core/shader/shader.h"
 
 namespace Pica {
 
+void ShaderEngine::RunBatch(const ShaderSetup& setup, std::span<ShaderUnit> states) const {
+    for (ShaderUnit& state : states) {
+        Run(setup, state);
+    }
+}
+
 std::unique_ptr<ShaderEngine> CreateEngine(bool use_jit) {
 #if CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
     if (use_jit) {
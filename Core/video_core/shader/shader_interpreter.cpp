@@ -3,8 +3,11 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <numeric>
+#include <optional>
+#include <span>
 #include <boost/circular_buffer.hpp>
 #include <boost/container/static_vector.hpp>
 #include <nihstro/shader_bytecode.h>
@@ -44,12 +47,26 @@ struct LoopStackElement {
     u8 previous_aL;
 };
 
+/// Control flow stacks of an invocation.
+struct InterpreterStacks {
+    boost::circular_buffer<IfStackElement> if_stack{8};
+    boost::circular_buffer<CallStackElement> call_stack{4};
+    boost::circular_buffer<LoopStackElement> loop_stack{4};
+};
+
+/**
+ * Runs the shader on a single shader unit.
+ * @param entry_point Address of the first instruction to run.
+ * @param stacks Control flow stacks at the first instruction, empty when starting at the entry
+ * point of the shader.
+ */
 template <bool Debug>
 static void RunInterpreter(const ShaderSetup& setup, ShaderUnit& state,
-                           DebugData<Debug>& debug_data, unsigned entry_point) {
-    boost::circular_buffer<IfStackElement> if_stack(8);
-    boost::circular_buffer<CallStackElement> call_stack(4);
-    boost::circular_buffer<LoopStackElement> loop_stack(4);
+                           DebugData<Debug>& debug_data, unsigned entry_point,
+                           InterpreterStacks& stacks) {
+    auto& if_stack = stacks.if_stack;
+    auto& call_stack = stacks.call_stack;
+    auto& loop_stack = stacks.loop_stack;
     u32 program_counter = entry_point;
 
     const auto do_if = [&](Instruction instr, bool condition) {
@@ -720,6 +737,620 @@ static void RunInterpreter(const ShaderSetup& setup, ShaderUnit& state,
     }
 }
 
+/// Number of shader units the batch interpreter runs in lockstep
+constexpr std::size_t BATCH_SIZE = 8;
+
+/// One register component of all shader units of a batch
+using BatchComponent = std::array<f24, BATCH_SIZE>;
+
+/// One register of all shader units of a batch, stored one component after another
+using BatchRegister = std::array<BatchComponent, 4>;
+
+/**
+ * State of the shader units of a batch in SoA layout. Every operation runs over the same
+ * component of all shader units at once, which lets the compiler vectorize across vertices.
+ */
+struct BatchUnit {
+    alignas(32) std::array<BatchRegister, 16> input{};
+    alignas(32) std::array<BatchRegister, 16> temporary{};
+    alignas(32) std::array<BatchRegister, 16> output{};
+    std::array<std::array<s32, BATCH_SIZE>, 3> address_registers{};
+    std::array<std::array<bool, BATCH_SIZE>, 2> conditional_code{};
+};
+
+static void LoadBatch(BatchUnit& batch, std::span<const ShaderUnit> states) {
+    for (std::size_t lane = 0; lane < states.size(); ++lane) {
+        const ShaderUnit& state = states[lane];
+        for (std::size_t reg = 0; reg < 16; ++reg) {
+            for (std::size_t i = 0; i < 4; ++i) {
+                batch.input[reg][i][lane] = state.input[reg][i];
+                batch.temporary[reg][i][lane] = state.temporary[reg][i];
+                batch.output[reg][i][lane] = state.output[reg][i];
+            }
+        }
+        for (std::size_t i = 0; i < 3; ++i) {
+            batch.address_registers[i][lane] = state.address_registers[i];
+        }
+        for (std::size_t i = 0; i < 2; ++i) {
+            batch.conditional_code[i][lane] = state.conditional_code[i];
+        }
+    }
+}
+
+static void StoreBatch(const BatchUnit& batch, std::span<ShaderUnit> states) {
+    for (std::size_t lane = 0; lane < states.size(); ++lane) {
+        ShaderUnit& state = states[lane];
+        for (std::size_t reg = 0; reg < 16; ++reg) {
+            for (std::size_t i = 0; i < 4; ++i) {
+                state.input[reg][i] = batch.input[reg][i][lane];
+                state.temporary[reg][i] = batch.temporary[reg][i][lane];
+                state.output[reg][i] = batch.output[reg][i][lane];
+            }
+        }
+        for (std::size_t i = 0; i < 3; ++i) {
+            state.address_registers[i] = batch.address_registers[i][lane];
+        }
+        for (std::size_t i = 0; i < 2; ++i) {
+            state.conditional_code[i] = batch.conditional_code[i][lane];
+        }
+    }
+}
+
+/**
+ * Runs the shader on the first num_units shader units of the batch in lockstep. Control flow
+ * depending on uniforms is the same for all of them, but conditional code dependent branches can
+ * diverge. In that case execution stops in front of the branch, so that each shader unit can
+ * finish on its own.
+ * @returns The address of the instruction the shader units diverged at, std::nullopt when the
+ * shader finished.
+ */
+static std::optional<u32> RunBatchInterpreter(const ShaderSetup& setup, BatchUnit& batch,
+                                              std::size_t num_units, InterpreterStacks& stacks) {
+    auto& if_stack = stacks.if_stack;
+    auto& call_stack = stacks.call_stack;
+    auto& loop_stack = stacks.loop_stack;
+    u32 program_counter = setup.entry_point;
+
+    const auto do_if = [&](Instruction instr, bool condition) {
+        if (condition) {
+            if_stack.push_back({
+                .else_address = instr.flow_control.dest_offset,
+                .end_address = instr.flow_control.dest_offset + instr.flow_control.num_instructions,
+            });
+        } else {
+            program_counter = instr.flow_control.dest_offset - 1;
+        }
+    };
+
+    const auto do_call = [&](Instruction instr) {
+        call_stack.push_back({
+            .end_address = instr.flow_control.dest_offset + instr.flow_control.num_instructions,
+            .return_address = program_counter + 1,
+        });
+        program_counter = instr.flow_control.dest_offset - 1;
+    };
+
+    // Returns the condition if it is the same for all shader units, std::nullopt otherwise.
+    const auto evaluate_condition =
+        [&](Instruction::FlowControlType flow_control) -> std::optional<bool> {
+        using Op = Instruction::FlowControlType::Op;
+
+        std::size_t num_true = 0;
+        for (std::size_t lane = 0; lane < num_units; ++lane) {
+            const bool result_x = flow_control.refx.Value() == batch.conditional_code[0][lane];
+            const bool result_y = flow_control.refy.Value() == batch.conditional_code[1][lane];
+
+            switch (flow_control.op) {
+            case Op::Or:
+                num_true += result_x || result_y;
+                break;
+            case Op::And:
+                num_true += result_x && result_y;
+                break;
+            case Op::JustX:
+                num_true += result_x;
+                break;
+            case Op::JustY:
+                num_true += result_y;
+                break;
+            default:
+                UNREACHABLE();
+                break;
+            }
+        }
+        if (num_true == 0 || num_true == num_units) {
+            return num_true != 0;
+        }
+        return std::nullopt;
+    };
+
+    const auto& uniforms = setup.uniforms;
+    const auto& swizzle_data = setup.swizzle_data;
+    const auto& program_code = setup.program_code;
+
+    // Loads a swizzled and optionally negated source register of all shader units.
+    const auto load_source = [&](BatchRegister& src, const SourceRegister& source_reg,
+                                 int address_register_index, const std::array<u32, 4>& selectors,
+                                 bool negate) {
+        const int index = source_reg.GetIndex();
+        switch (source_reg.GetRegisterType()) {
+        case RegisterType::Input:
+        case RegisterType::Temporary: {
+            const BatchRegister& reg = source_reg.GetRegisterType() == RegisterType::Input
+                                           ? batch.input[index]
+                                           : batch.temporary[index];
+            for (std::size_t i = 0; i < 4; ++i) {
+                src[i] = reg[selectors[i]];
+            }
+            break;
+        }
+
+        case RegisterType::FloatUniform:
+            if (address_register_index == 0) {
+                for (std::size_t i = 0; i < 4; ++i) {
+                    src[i].fill(uniforms.f[index][selectors[i]]);
+                }
+                break;
+            }
+            // Relative addressing, each shader unit can read a different uniform.
+            for (std::size_t lane = 0; lane < BATCH_SIZE; ++lane) {
+                int offset = batch.address_registers[address_register_index - 1][lane];
+                if (offset < std::numeric_limits<s8>::min() ||
+                    offset > std::numeric_limits<s8>::max()) [[unlikely]] {
+                    offset = 0;
+                }
+                const int lane_index = (index + offset) & 0x7F;
+                for (std::size_t i = 0; i < 4; ++i) {
+                    // If the index is above 96, the result is all one.
+                    src[i][lane] =
+                        lane_index >= 96 ? f24::One() : uniforms.f[lane_index][selectors[i]];
+                }
+            }
+            break;
+
+        default:
+            for (std::size_t i = 0; i < 4; ++i) {
+                src[i].fill(f24::Zero());
+            }
+            break;
+        }
+
+        if (negate) {
+            for (std::size_t i = 0; i < 4; ++i) {
+                for (std::size_t lane = 0; lane < BATCH_SIZE; ++lane) {
+                    src[i][lane] = -src[i][lane];
+                }
+            }
+        }
+    };
+
+    // Destination of writes to registers that do not exist
+    BatchRegister dummy_dest;
+
+    bool should_stop = false;
+    while (!should_stop) {
+        bool is_break = false;
+        const u32 old_program_counter = program_counter;
+
+        const Instruction instr = {program_code[program_counter]};
+        const SwizzlePattern swizzle = {swizzle_data[instr.common.operand_desc_id]};
+
+        switch (instr.opcode.Value().GetInfo().type) {
+        case OpCode::Type::Arithmetic: {
+            const bool is_inverted =
+                (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+
+            BatchRegister src1;
+            BatchRegister src2;
+            load_source(src1, instr.common.GetSrc1(is_inverted),
+                        !is_inverted * instr.common.address_register_index,
+                        {
+                            static_cast<u32>(swizzle.src1_selector_0.Value()),
+                            static_cast<u32>(swizzle.src1_selector_1.Value()),
+                            static_cast<u32>(swizzle.src1_selector_2.Value()),
+                            static_cast<u32>(swizzle.src1_selector_3.Value()),
+                        },
+                        swizzle.negate_src1.Value() != 0);
+            load_source(src2, instr.common.GetSrc2(is_inverted),
+                        is_inverted * instr.common.address_register_index,
+                        {
+                            static_cast<u32>(swizzle.src2_selector_0.Value()),
+                            static_cast<u32>(swizzle.src2_selector_1.Value()),
+                            static_cast<u32>(swizzle.src2_selector_2.Value()),
+                            static_cast<u32>(swizzle.src2_selector_3.Value()),
+                        },
+                        swizzle.negate_src2.Value() != 0);
+
+            BatchRegister& dest =
+                (instr.common.dest.Value() < 0x10)
+                    ? batch.output[instr.common.dest.Value().GetIndex()]
+                : (instr.common.dest.Value() < 0x20)
+                    ? batch.temporary[instr.common.dest.Value().GetIndex()]
+                    : dummy_dest;
+
+            // Writes func(component, lane) to the enabled destination components.
+            const auto write_dest = [&](auto&& func) {
+                for (std::size_t i = 0; i < 4; ++i) {
+                    if (!swizzle.DestComponentEnabled(i))
+                        continue;
+
+                    for (std::size_t lane = 0; lane < BATCH_SIZE; ++lane) {
+                        dest[i][lane] = func(i, lane);
+                    }
+                }
+            };
+
+            // Writes func(lane) of the first source component to all enabled components.
+            const auto write_scalar = [&](auto&& func) {
+                BatchComponent result;
+                for (std::size_t lane = 0; lane < BATCH_SIZE; ++lane) {
+                    result[lane] = func(src1[0][lane].ToFloat32());
+                }
+                write_dest([&](std::size_t, std::size_t lane) { return result[lane]; });
+            };
+
+            switch (instr.opcode.Value().EffectiveOpCode()) {
+            case OpCode::Id::ADD:
+                write_dest([&](std::size_t i, std::size_t lane) {
+                    return src1[i][lane] + src2[i][lane];
+                });
+                break;
+
+            case OpCode::Id::MUL:
+                write_dest([&](std::size_t i, std::size_t lane) {
+                    return src1[i][lane] * src2[i][lane];
+                });
+                break;
+
+            case OpCode::Id::FLR:
+                write_dest([&](std::size_t i, std::size_t lane) {
+                    return f24::FromFloat32(std::floor(src1[i][lane].ToFloat32()));
+                });
+                break;
+
+            case OpCode::Id::MAX:
+                // Same form as the interpreter to match the NaN semantics of the hardware.
+                write_dest([&](std::size_t i, std::size_t lane) {
+                    return (src1[i][lane] > src2[i][lane]) ? src1[i][lane] : src2[i][lane];
+                });
+                break;
+
+            case OpCode::Id::MIN:
+                write_dest([&](std::size_t i, std::size_t lane) {
+                    return (src1[i][lane] < src2[i][lane]) ? src1[i][lane] : src2[i][lane];
+                });
+                break;
+
+            case OpCode::Id::DP3:
+            case OpCode::Id::DP4:
+            case OpCode::Id::DPH:
+            case OpCode::Id::DPHI: {
+                OpCode::Id opcode = instr.opcode.Value().EffectiveOpCode();
+                if (opcode == OpCode::Id::DPH || opcode == OpCode::Id::DPHI)
+                    src1[3].fill(f24::One());
+
+                const std::size_t num_components = (opcode == OpCode::Id::DP3) ? 3 : 4;
+                BatchComponent dot;
+                dot.fill(f24::Zero());
+                for (std::size_t i = 0; i < num_components; ++i) {
+                    for (std::size_t lane = 0; lane < BATCH_SIZE; ++lane) {
+                        dot[lane] = dot[lane] + src1[i][lane] * src2[i][lane];
+                    }
+                }
+                write_dest([&](std::size_t, std::size_t lane) { return dot[lane]; });
+                break;
+            }
+
+            case OpCode::Id::RCP:
+                write_scalar([](float value) { return f24::FromFloat32(1.0f / value); });
+                break;
+
+            case OpCode::Id::RSQ:
+                write_scalar(
+                    [](float value) { return f24::FromFloat32(1.0f / std::sqrt(value)); });
+                break;
+
+            case OpCode::Id::MOVA:
+                for (std::size_t i = 0; i < 2; ++i) {
+                    if (!swizzle.DestComponentEnabled(i))
+                        continue;
+
+                    for (std::size_t lane = 0; lane < num_units; ++lane) {
+                        batch.address_registers[i][lane] =
+                            static_cast<s32>(src1[i][lane].ToFloat32());
+                    }
+                }
+                break;
+
+            case OpCode::Id::MOV:
+                write_dest([&](std::size_t i, std::size_t lane) { return src1[i][lane]; });
+                break;
+
+            case OpCode::Id::SGE:
+            case OpCode::Id::SGEI:
+                write_dest([&](std::size_t i, std::size_t lane) {
+                    return (src1[i][lane] >= src2[i][lane]) ? f24::One() : f24::Zero();
+                });
+                break;
+
+            case OpCode::Id::SLT:
+            case OpCode::Id::SLTI:
+                write_dest([&](std::size_t i, std::size_t lane) {
+                    return (src1[i][lane] < src2[i][lane]) ? f24::One() : f24::Zero();
+                });
+                break;
+
+            case OpCode::Id::CMP:
+                for (std::size_t i = 0; i < 2; ++i) {
+                    const auto compare_op = instr.common.compare_op;
+                    const auto op = (i == 0) ? compare_op.x.Value() : compare_op.y.Value();
+                    auto& result = batch.conditional_code[i];
+                    const BatchComponent& lhs = src1[i];
+                    const BatchComponent& rhs = src2[i];
+
+                    switch (op) {
+                    case Instruction::Common::CompareOpType::Equal:
+                        for (std::size_t lane = 0; lane < BATCH_SIZE; ++lane)
+                            result[lane] = lhs[lane] == rhs[lane];
+                        break;
+
+                    case Instruction::Common::CompareOpType::NotEqual:
+                        for (std::size_t lane = 0; lane < BATCH_SIZE; ++lane)
+                            result[lane] = lhs[lane] != rhs[lane];
+                        break;
+
+                    case Instruction::Common::CompareOpType::LessThan:
+                        for (std::size_t lane = 0; lane < BATCH_SIZE; ++lane)
+                            result[lane] = lhs[lane] < rhs[lane];
+                        break;
+
+                    case Instruction::Common::CompareOpType::LessEqual:
+                        for (std::size_t lane = 0; lane < BATCH_SIZE; ++lane)
+                            result[lane] = lhs[lane] <= rhs[lane];
+                        break;
+
+                    case Instruction::Common::CompareOpType::GreaterThan:
+                        for (std::size_t lane = 0; lane < BATCH_SIZE; ++lane)
+                            result[lane] = lhs[lane] > rhs[lane];
+                        break;
+
+                    case Instruction::Common::CompareOpType::GreaterEqual:
+                        for (std::size_t lane = 0; lane < BATCH_SIZE; ++lane)
+                            result[lane] = lhs[lane] >= rhs[lane];
+                        break;
+
+                    default:
+                        LOG_ERROR(HW_GPU, "Unknown compare mode {:x}", static_cast<int>(op));
+                        break;
+                    }
+                }
+                break;
+
+            case OpCode::Id::EX2:
+                write_scalar([](float value) { return f24::FromFloat32(std::exp2(value)); });
+                break;
+
+            case OpCode::Id::LG2:
+                write_scalar([](float value) { return f24::FromFloat32(std::log2(value)); });
+                break;
+
+            default:
+                LOG_ERROR(HW_GPU, "Unhandled arithmetic instruction: 0x{:02x} ({}): 0x{:08x}",
+                          (int)instr.opcode.Value().EffectiveOpCode(),
+                          instr.opcode.Value().GetInfo().name, instr.hex);
+                DEBUG_ASSERT(false);
+                break;
+            }
+
+            break;
+        }
+
+        case OpCode::Type::MultiplyAdd: {
+            if ((instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD) ||
+                (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI)) {
+                const SwizzlePattern& mad_swizzle = *reinterpret_cast<const SwizzlePattern*>(
+                    &swizzle_data[instr.mad.operand_desc_id]);
+
+                bool is_inverted = (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI);
+
+                BatchRegister src1;
+                BatchRegister src2;
+                BatchRegister src3;
+                load_source(src1, instr.mad.GetSrc1(is_inverted), 0,
+                            {
+                                static_cast<u32>(mad_swizzle.src1_selector_0.Value()),
+                                static_cast<u32>(mad_swizzle.src1_selector_1.Value()),
+                                static_cast<u32>(mad_swizzle.src1_selector_2.Value()),
+                                static_cast<u32>(mad_swizzle.src1_selector_3.Value()),
+                            },
+                            mad_swizzle.negate_src1.Value() != 0);
+                load_source(src2, instr.mad.GetSrc2(is_inverted),
+                            !is_inverted * instr.mad.address_register_index,
+                            {
+                                static_cast<u32>(mad_swizzle.src2_selector_0.Value()),
+                                static_cast<u32>(mad_swizzle.src2_selector_1.Value()),
+                                static_cast<u32>(mad_swizzle.src2_selector_2.Value()),
+                                static_cast<u32>(mad_swizzle.src2_selector_3.Value()),
+                            },
+                            mad_swizzle.negate_src2.Value() != 0);
+                load_source(src3, instr.mad.GetSrc3(is_inverted),
+                            is_inverted * instr.mad.address_register_index,
+                            {
+                                static_cast<u32>(mad_swizzle.src3_selector_0.Value()),
+                                static_cast<u32>(mad_swizzle.src3_selector_1.Value()),
+                                static_cast<u32>(mad_swizzle.src3_selector_2.Value()),
+                                static_cast<u32>(mad_swizzle.src3_selector_3.Value()),
+                            },
+                            mad_swizzle.negate_src3.Value() != 0);
+
+                BatchRegister& dest = (instr.mad.dest.Value() < 0x10)
+                                          ? batch.output[instr.mad.dest.Value().GetIndex()]
+                                      : (instr.mad.dest.Value() < 0x20)
+                                          ? batch.temporary[instr.mad.dest.Value().GetIndex()]
+                                          : dummy_dest;
+
+                for (std::size_t i = 0; i < 4; ++i) {
+                    if (!mad_swizzle.DestComponentEnabled(i))
+                        continue;
+
+                    for (std::size_t lane = 0; lane < BATCH_SIZE; ++lane) {
+                        dest[i][lane] = src1[i][lane] * src2[i][lane] + src3[i][lane];
+                    }
+                }
+            } else {
+                LOG_ERROR(HW_GPU, "Unhandled multiply-add instruction: 0x{:02x} ({}): 0x{:08x}",
+                          (int)instr.opcode.Value().EffectiveOpCode(),
+                          instr.opcode.Value().GetInfo().name, instr.hex);
+            }
+            break;
+        }
+
+        default: {
+            // Handle each instruction on its own
+            switch (instr.opcode.Value()) {
+            case OpCode::Id::END:
+                should_stop = true;
+                break;
+
+            case OpCode::Id::JMPC: {
+                const std::optional<bool> cond = evaluate_condition(instr.flow_control);
+                if (!cond) {
+                    return program_counter;
+                }
+                if (*cond) {
+                    program_counter = instr.flow_control.dest_offset - 1;
+                }
+                break;
+            }
+
+            case OpCode::Id::JMPU:
+                if (uniforms.b[instr.flow_control.bool_uniform_id] ==
+                    !(instr.flow_control.num_instructions & 1)) {
+                    program_counter = instr.flow_control.dest_offset - 1;
+                }
+                break;
+
+            case OpCode::Id::CALL:
+                do_call(instr);
+                break;
+
+            case OpCode::Id::CALLU:
+                if (uniforms.b[instr.flow_control.bool_uniform_id]) {
+                    do_call(instr);
+                }
+                break;
+
+            case OpCode::Id::CALLC: {
+                const std::optional<bool> cond = evaluate_condition(instr.flow_control);
+                if (!cond) {
+                    return program_counter;
+                }
+                if (*cond) {
+                    do_call(instr);
+                }
+                break;
+            }
+
+            case OpCode::Id::NOP:
+                break;
+
+            case OpCode::Id::IFU:
+                do_if(instr, uniforms.b[instr.flow_control.bool_uniform_id]);
+                break;
+
+            case OpCode::Id::IFC: {
+                const std::optional<bool> cond = evaluate_condition(instr.flow_control);
+                if (!cond) {
+                    return program_counter;
+                }
+                do_if(instr, *cond);
+                break;
+            }
+
+            case OpCode::Id::LOOP: {
+                const Common::Vec4<u8>& loop_param = uniforms.i[instr.flow_control.int_uniform_id];
+                batch.address_registers[2].fill(loop_param.y);
+
+                loop_stack.push_back({
+                    .entry_address = program_counter + 1,
+                    .end_address = instr.flow_control.dest_offset + 1,
+                    .loop_downcounter = loop_param.x,
+                    .address_increment = loop_param.z,
+                    .previous_aL = loop_param.y,
+                });
+                break;
+            }
+
+            case OpCode::Id::BREAK:
+                is_break = true;
+                break;
+
+            case OpCode::Id::BREAKC: {
+                const std::optional<bool> cond = evaluate_condition(instr.flow_control);
+                if (!cond) {
+                    return program_counter;
+                }
+                is_break = *cond;
+                break;
+            }
+
+            case OpCode::Id::EMIT:
+            case OpCode::Id::SETEMIT:
+                // Geometry shaders are not batched, leave them to the interpreter.
+                return program_counter;
+
+            default:
+                LOG_ERROR(HW_GPU, "Unhandled instruction: 0x{:02x} ({}): 0x{:08x}",
+                          (int)instr.opcode.Value().EffectiveOpCode(),
+                          instr.opcode.Value().GetInfo().name, instr.hex);
+                break;
+            }
+
+            break;
+        }
+        }
+
+        ++program_counter;
+
+        // Close the scopes the same way as the interpreter does.
+        u32 next_program_counter = old_program_counter + 1;
+        for (u32 i = 0; i < 4; i++) {
+            if (call_stack.empty() || call_stack.back().end_address != next_program_counter)
+                break;
+            if (i < 3) {
+                program_counter = call_stack.back().return_address;
+                next_program_counter = program_counter;
+            }
+            call_stack.pop_back();
+        }
+
+        if (!if_stack.empty() && if_stack.back().else_address == old_program_counter + 1) {
+            program_counter = if_stack.back().end_address;
+            if_stack.pop_back();
+        }
+
+        if (!loop_stack.empty() &&
+            (loop_stack.back().end_address == old_program_counter + 1 || is_break)) {
+            auto& loop = loop_stack.back();
+            auto& aL = batch.address_registers[2];
+            for (std::size_t lane = 0; lane < BATCH_SIZE; ++lane) {
+                aL[lane] += loop.address_increment;
+            }
+            if (!is_break && loop.loop_downcounter--) {
+                program_counter = loop.entry_address;
+            } else {
+                program_counter = loop.end_address;
+                // Only restore previous value if there is a surrounding LOOP scope.
+                if (loop_stack.size() > 1)
+                    aL.fill(loop.previous_aL);
+                loop_stack.pop_back();
+            }
+        }
+    }
+
+    return std::nullopt;
+}
+
 void InterpreterEngine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
     ASSERT(entry_point < MAX_PROGRAM_CODE_LENGTH);
     setup.entry_point = entry_point;
@@ -732,7 +1363,37 @@ void InterpreterEngine::Run(const ShaderSetup& setup, ShaderUnit& state) const {
     MICROPROFILE_SCOPE(GPU_Shader);
 
     DebugData<false> dummy_debug_data;
-    RunInterpreter(setup, state, dummy_debug_data, setup.entry_point);
+    InterpreterStacks stacks;
+    RunInterpreter(setup, state, dummy_debug_data, setup.entry_point, stacks);
+}
+
+void InterpreterEngine::RunBatch(const ShaderSetup& setup, std::span<ShaderUnit> states) const {
+    MICROPROFILE_SCOPE(GPU_Shader);
+
+    DebugData<false> dummy_debug_data;
+    BatchUnit batch;
+    for (std::size_t first = 0; first < states.size(); first += BATCH_SIZE) {
+        const auto units = states.subspan(first, std::min(BATCH_SIZE, states.size() - first));
+        if (units.size() == 1) {
+            InterpreterStacks stacks;
+            RunInterpreter(setup, units[0], dummy_debug_data, setup.entry_point, stacks);
+            continue;
+        }
+
+        InterpreterStacks stacks;
+        LoadBatch(batch, units);
+        const std::optional<u32> diverged_at =
+            RunBatchInterpreter(setup, batch, units.size(), stacks);
+        StoreBatch(batch, units);
+
+        // The shader units took different branches, finish each one on its own.
+        if (diverged_at) {
+            for (ShaderUnit& state : units) {
+                InterpreterStacks unit_stacks = stacks;
+                RunInterpreter(setup, state, dummy_debug_data, *diverged_at, unit_stacks);
+            }
+        }
+    }
 }
 
 DebugData<true> InterpreterEngine::ProduceDebugInfo(const ShaderSetup& setup,
@@ -744,7 +1405,8 @@ DebugData<true> InterpreterEngine::ProduceDebugInfo(const ShaderSetup& setup,
     // Setup input register table
     state.input.fill(Common::Vec4<f24>::AssignToAll(f24::Zero()));
     state.LoadInput(config, input);
-    RunInterpreter(setup, state, debug_data, setup.entry_point);
+    InterpreterStacks stacks;
+    RunInterpreter(setup, state, debug_data, setup.entry_point, stacks);
     return debug_data;
 }
 
@@ -5,9 +5,11 @@
 #include "common/arch.h"
 #if CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
 
+#include <algorithm>
 #include "common/assert.h"
 #include "common/hash.h"
 #include "common/microprofile.h"
+#include "common/settings.h"
 #include "video_core/shader/shader.h"
 #include "video_core/shader/shader_jit.h"
 #if CITRA_ARCH(arm64)
@@ -19,8 +21,12 @@
 
 namespace Pica::Shader {
 
-JitEngine::JitEngine() = default;
-JitEngine::~JitEngine() = default;
+JitEngine::JitEngine() : precompile_worker{1, "ShaderJitCache"} {}
+
+JitEngine::~JitEngine() {
+    stop_precompile = true;
+    precompile_worker.WaitForRequests();
+}
 
 void JitEngine::SetupBatch(ShaderSetup& setup, u32 entry_point) {
     ASSERT(entry_point < MAX_PROGRAM_CODE_LENGTH);
@@ -32,19 +38,55 @@ void JitEngine::SetupBatch(ShaderSetup& setup, u32 entry_point) {
     const u64 cache_key = Common::HashCombine(code_hash, swizzle_hash);
     auto iter = cache.find(cache_key);
     if (iter != cache.end()) {
-        setup.cached_shader = iter->second.get();
-    } else {
-        auto shader = std::make_unique<JitShader>();
+        stats.hits++;
+        lru.splice(lru.begin(), lru, iter->second.lru_it);
+        bound_keys[&setup] = cache_key;
+        setup.cached_shader = iter->second.shader.get();
+        return;
+    }
+    // Programs queued on the worker counted their miss when the compile was queued.
+    if (!pending.contains(cache_key)) {
+        stats.misses++;
+    }
+
+    auto shader = TakePrecompiled(cache_key);
+    if (!shader) {
+        disk_cache.Append(cache_key, setup.program_code, setup.swizzle_data);
+
+        // Interpret the program until the worker has compiled it. The compiled shader is
+        // picked up by the first SetupBatch call after it becomes available.
+        if (Settings::values.async_shader_jit) {
+            if (pending.insert(cache_key).second) {
+                auto entry = std::make_unique<JitDiskCache::Entry>();
+                entry->key = cache_key;
+                entry->program_code = setup.program_code;
+                entry->swizzle_data = setup.swizzle_data;
+                QueueCompile(std::move(entry), false);
+            }
+            bound_keys.erase(&setup);
+            setup.cached_shader = nullptr;
+            return;
+        }
+
+        shader = std::make_unique<JitShader>();
         shader->Compile(&setup.program_code, &setup.swizzle_data);
-        setup.cached_shader = shader.get();
-        cache.emplace_hint(iter, cache_key, std::move(shader));
     }
+    pending.erase(cache_key);
+    lru.push_front(cache_key);
+    code_size += shader->GetCodeSize();
+    bound_keys[&setup] = cache_key;
+    setup.cached_shader = shader.get();
+    cache.emplace_hint(iter, cache_key, CacheEntry{std::move(shader), lru.begin()});
+    EvictShaders();
 }
 
 MICROPROFILE_DECLARE(GPU_Shader);
 
 void JitEngine::Run(const ShaderSetup& setup, ShaderUnit& state) const {
-    ASSERT(setup.cached_shader != nullptr);
+    if (!setup.cached_shader) {
+        interpreter.Run(setup, state);
+        return;
+    }
 
     MICROPROFILE_SCOPE(GPU_Shader);
 
@@ -52,6 +94,135 @@ void JitEngine::Run(const ShaderSetup& setup, ShaderUnit& state) const {
     shader->Run(setup, state, setup.entry_point);
 }
 
+void JitEngine::RunBatch(const ShaderSetup& setup, std::span<ShaderUnit> states) const {
+    if (!setup.cached_shader) {
+        interpreter.RunBatch(setup, states);
+        return;
+    }
+
+    MICROPROFILE_SCOPE(GPU_Shader);
+
+    const JitShader* shader = static_cast<const JitShader*>(setup.cached_shader);
+    for (ShaderUnit& state : states) {
+        shader->Run(setup, state, setup.entry_point);
+    }
+}
+
+void JitEngine::SwitchDiskCache(u64 title_id) {
+    if (title_id == current_title_id) {
+        return;
+    }
+    current_title_id = title_id;
+
+    // Abandon the programs of the previous title that have not been compiled yet and free the
+    // ones that were compiled but never used.
+    stop_precompile = true;
+    precompile_worker.WaitForRequests();
+    stop_precompile = false;
+    pending.clear();
+    {
+        std::scoped_lock lock{precompiled_mutex};
+        precompiled.clear();
+        precompiled_size = 0;
+    }
+
+    // Compile the programs seen in previous sessions on the worker, they are picked up by
+    // SetupBatch once the application uses them.
+    for (auto& entry : disk_cache.Open(title_id)) {
+        if (!cache.contains(entry->key)) {
+            QueueCompile(std::move(entry), true);
+        }
+    }
+}
+
+void JitEngine::QueueCompile(std::unique_ptr<JitDiskCache::Entry> entry, bool preload) {
+    precompile_worker.QueueWork([this, preload, entry = std::move(entry)] {
+        if (stop_precompile) {
+            return;
+        }
+        const auto over_budget = [this](std::size_t size) {
+            return code_size + precompiled_size + size > GetCacheBudget();
+        };
+        if (preload) {
+            std::scoped_lock lock{precompiled_mutex};
+            if (over_budget(0)) {
+                return;
+            }
+        }
+
+        auto shader = std::make_unique<JitShader>();
+        shader->Compile(&entry->program_code, &entry->swizzle_data);
+        const std::size_t shader_size = shader->GetCodeSize();
+
+        std::scoped_lock lock{precompiled_mutex};
+        if (preload && over_budget(shader_size)) {
+            return;
+        }
+        if (precompiled.try_emplace(entry->key, std::move(shader)).second) {
+            precompiled_size += shader_size;
+        }
+    });
+}
+
+JitEngine::CacheStats JitEngine::GetCacheStats() const noexcept {
+    CacheStats result = stats;
+    result.code_size = code_size;
+    result.num_shaders = cache.size();
+    return result;
+}
+
+void JitEngine::ResetCacheStats() noexcept {
+    stats = {};
+}
+
+std::size_t JitEngine::GetCacheBudget() {
+    return static_cast<std::size_t>(Settings::values.shader_jit_cache_size.GetValue()) << 20;
+}
+
+void JitEngine::EvictShaders() {
+    const std::size_t budget = GetCacheBudget();
+    auto it = lru.end();
+    while (code_size > budget && it != lru.begin()) {
+        --it;
+        const u64 key = *it;
+
+        // Shaders referenced by a shader setup may still be executed and can not be freed.
+        if (std::ranges::any_of(bound_keys,
+                                [key](const auto& binding) { return binding.second == key; })) {
+            continue;
+        }
+
+        const auto entry = cache.find(key);
+        code_size -= entry->second.shader->GetCodeSize();
+        cache.erase(entry);
+        it = lru.erase(it);
+        stats.evictions++;
+    }
+
+    // Shaders compiled ahead of use share the budget and are dropped after the unused ones.
+    // A program that missed the cache is compiled again on its next use.
+    std::scoped_lock lock{precompiled_mutex};
+    for (auto entry = precompiled.begin();
+         entry != precompiled.end() && code_size + precompiled_size > budget;) {
+        precompiled_size -= entry->second->GetCodeSize();
+        pending.erase(entry->first);
+        entry = precompiled.erase(entry);
+        stats.evictions++;
+    }
+}
+
+std::unique_ptr<JitShader> JitEngine::TakePrecompiled(u64 cache_key) {
+    std::scoped_lock lock{precompiled_mutex};
+    const auto it = precompiled.find(cache_key);
+    if (it == precompiled.end()) {
+        return nullptr;
+    }
+    auto shader = std::move(it->second);
+    precompiled.erase(it);
+    precompiled_size -= shader->GetCodeSize();
+    return shader;
+}
+
 } // namespace Pica::Shader
 
 #endif // CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
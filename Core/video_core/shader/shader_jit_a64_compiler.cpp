@@ -985,7 +985,7 @@ void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_
     return_offsets.shrink_to_fit();
 
     // Copy to executable memory
-    const size_t code_size = code_vec.size() * sizeof(u32);
+    code_size = code_vec.size() * sizeof(u32);
 
     code_mem = std::make_unique<oaknut::CodeBlock>(code_size);
     code_mem->unprotect();
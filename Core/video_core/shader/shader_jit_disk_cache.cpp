@@ -0,0 +1,154 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <fmt/format.h>
+#include "common/common_paths.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/settings.h"
+#include "video_core/shader/shader_jit_disk_cache.h"
+
+namespace Pica::Shader {
+
+namespace {
+
+constexpr u32 CACHE_MAGIC = 0x54494A50; // "PJIT"
+constexpr u32 CACHE_VERSION = 1;
+
+struct CacheHeader {
+    u32 magic;
+    u32 version;
+};
+
+struct EntryHeader {
+    u64 key;
+    u32 program_length;
+    u32 swizzle_length;
+};
+
+/// Returns the number of words up to and including the last non-zero one.
+template <std::size_t N>
+u32 UsedLength(const std::array<u32, N>& data) {
+    const auto last = std::find_if(data.rbegin(), data.rend(), [](u32 word) { return word != 0; });
+    return static_cast<u32>(std::distance(last, data.rend()));
+}
+
+u64 ComputeKey(const ProgramCode& program_code, const SwizzleData& swizzle_data) {
+    return Common::HashCombine(Common::ComputeHash64(&program_code, sizeof(program_code)),
+                               Common::ComputeHash64(&swizzle_data, sizeof(swizzle_data)));
+}
+
+bool WriteEntry(FileUtil::IOFile& file, u64 key, const ProgramCode& program_code,
+                const SwizzleData& swizzle_data) {
+    const EntryHeader header{
+        .key = key,
+        .program_length = UsedLength(program_code),
+        .swizzle_length = UsedLength(swizzle_data),
+    };
+    return file.WriteObject(header) == 1 &&
+           file.WriteArray(program_code.data(), header.program_length) == header.program_length &&
+           file.WriteArray(swizzle_data.data(), header.swizzle_length) == header.swizzle_length;
+}
+
+std::string GetCacheDir() {
+    return FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir) + "jit" + DIR_SEP;
+}
+
+} // Anonymous namespace
+
+JitDiskCache::JitDiskCache() = default;
+
+JitDiskCache::~JitDiskCache() = default;
+
+std::vector<std::unique_ptr<JitDiskCache::Entry>> JitDiskCache::Open(u64 title_id) {
+    file.Close();
+    stored_keys.clear();
+
+    std::vector<std::unique_ptr<Entry>> entries;
+    if (!Settings::values.use_disk_shader_cache) {
+        return entries;
+    }
+
+    const auto cache_dir = GetCacheDir();
+    if (!FileUtil::CreateFullPath(cache_dir)) {
+        LOG_ERROR(HW_GPU, "Failed to create directory={}", cache_dir);
+        return entries;
+    }
+
+    const auto cache_file_path = fmt::format("{}{:016X}.bin", cache_dir, title_id);
+    bool is_valid = false;
+    if (FileUtil::IOFile cache_file{cache_file_path, "rb"}; cache_file.IsOpen()) {
+        CacheHeader header{};
+        is_valid = cache_file.ReadArray(&header, 1) == 1 && header.magic == CACHE_MAGIC &&
+                   header.version == CACHE_VERSION;
+
+        EntryHeader entry_header{};
+        while (is_valid && cache_file.ReadArray(&entry_header, 1) == 1) {
+            if (entry_header.program_length > MAX_PROGRAM_CODE_LENGTH ||
+                entry_header.swizzle_length > MAX_SWIZZLE_DATA_LENGTH) {
+                is_valid = false;
+                break;
+            }
+
+            auto entry = std::make_unique<Entry>();
+            if (cache_file.ReadArray(entry->program_code.data(), entry_header.program_length) !=
+                    entry_header.program_length ||
+                cache_file.ReadArray(entry->swizzle_data.data(), entry_header.swizzle_length) !=
+                    entry_header.swizzle_length) {
+                is_valid = false;
+                break;
+            }
+
+            // Discard entries whose contents do not match the key they were stored with.
+            entry->key = ComputeKey(entry->program_code, entry->swizzle_data);
+            if (entry->key != entry_header.key) {
+                is_valid = false;
+                break;
+            }
+            if (stored_keys.insert(entry->key).second) {
+                entries.push_back(std::move(entry));
+            }
+        }
+    }
+
+    if (is_valid) {
+        LOG_INFO(HW_GPU, "Loaded {} shader programs from JIT cache for title_id={:016X}",
+                 entries.size(), title_id);
+        file = FileUtil::IOFile{cache_file_path, "ab"};
+        return entries;
+    }
+
+    // Rewrite the file with the entries that could be recovered.
+    file = FileUtil::IOFile{cache_file_path, "wb"};
+    const CacheHeader header{
+        .magic = CACHE_MAGIC,
+        .version = CACHE_VERSION,
+    };
+    if (!file.IsOpen() || file.WriteObject(header) != 1) {
+        LOG_ERROR(HW_GPU, "Unable to open JIT cache for writing");
+        file.Close();
+        return entries;
+    }
+    for (const auto& entry : entries) {
+        WriteEntry(file, entry->key, entry->program_code, entry->swizzle_data);
+    }
+    file.Flush();
+    return entries;
+}
+
+void JitDiskCache::Append(u64 key, const ProgramCode& program_code,
+                          const SwizzleData& swizzle_data) {
+    if (!file.IsOpen() || !stored_keys.insert(key).second) {
+        return;
+    }
+    if (!WriteEntry(file, key, program_code, swizzle_data)) {
+        LOG_ERROR(HW_GPU, "Error during JIT cache write");
+        file.Close();
+        return;
+    }
+    file.Flush();
+}
+
+} // namespace Pica::Shader
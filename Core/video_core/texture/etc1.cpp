@@ -4,12 +4,20 @@
 
 #include <algorithm>
 #include <array>
+#include <cstring>
+#include "common/arch.h"
 #include "common/bit_field.h"
 #include "common/color.h"
 #include "common/common_types.h"
 #include "common/vector_math.h"
 #include "video_core/texture/etc1.h"
 
+#if CITRA_ARCH(x86_64)
+#include <emmintrin.h>
+#elif CITRA_ARCH(arm64)
+#include <arm_neon.h>
+#endif
+
 namespace Pica::Texture {
 
 namespace {
@@ -69,6 +77,31 @@ union ETC1Tile {
         BitField<60, 4, u64> r1;
     } separate;
 
+    /// Returns the base color of the subblock, which is the left/top one for subblock 0.
+    Common::Vec3<u8> GetBaseColor(unsigned subblock) const {
+        if (differential_mode) {
+            int r = static_cast<int>(differential.r);
+            int g = static_cast<int>(differential.g);
+            int b = static_cast<int>(differential.b);
+            if (subblock) {
+                r += static_cast<int>(differential.dr);
+                g += static_cast<int>(differential.dg);
+                b += static_cast<int>(differential.db);
+            }
+            return {Common::Color::Convert5To8(static_cast<u8>(r)),
+                    Common::Color::Convert5To8(static_cast<u8>(g)),
+                    Common::Color::Convert5To8(static_cast<u8>(b))};
+        }
+        if (subblock) {
+            return {Common::Color::Convert4To8(static_cast<u8>(separate.r2)),
+                    Common::Color::Convert4To8(static_cast<u8>(separate.g2)),
+                    Common::Color::Convert4To8(static_cast<u8>(separate.b2))};
+        }
+        return {Common::Color::Convert4To8(static_cast<u8>(separate.r1)),
+                Common::Color::Convert4To8(static_cast<u8>(separate.g1)),
+                Common::Color::Convert4To8(static_cast<u8>(separate.b1))};
+    }
+
     const Common::Vec3<u8> GetRGB(unsigned int x, unsigned int y) const {
         int texel = 4 * x + y;
 
@@ -117,6 +150,51 @@ union ETC1Tile {
     }
 };
 
+using Palette = std::array<Common::Vec4<u8>, 8>;
+static_assert(sizeof(Palette) == 32);
+
+/**
+ * Computes the four colors a subblock can take, base + small, base + large, base - small and
+ * base - large, in the order selected by the texel index bits (negation << 1 | subindex).
+ */
+void ComputeSubblockPalette(Common::Vec3<u8> base, const std::array<u8, 2>& modifiers,
+                            Common::Vec4<u8>* palette) {
+    const u8 small = modifiers[0];
+    const u8 large = modifiers[1];
+#if CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
+    // Saturating arithmetic performs the clamping to [0, 255].
+    const u32 color = base.r() | (base.g() << 8) | (base.b() << 16);
+    const u32 small_rgb = small * 0x010101U;
+    const u32 large_rgb = large * 0x010101U;
+#if CITRA_ARCH(x86_64)
+    const __m128i colors = _mm_set1_epi32(static_cast<int>(color));
+    const int small_word = static_cast<int>(small_rgb);
+    const int large_word = static_cast<int>(large_rgb);
+    const __m128i add = _mm_setr_epi32(small_word, large_word, 0, 0);
+    const __m128i sub = _mm_setr_epi32(0, 0, small_word, large_word);
+    const __m128i result = _mm_subs_epu8(_mm_adds_epu8(colors, add), sub);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(palette), result);
+#else
+    const uint32x4_t add_words = {small_rgb, large_rgb, 0, 0};
+    const uint32x4_t sub_words = {0, 0, small_rgb, large_rgb};
+    const uint8x16_t colors = vreinterpretq_u8_u32(vdupq_n_u32(color));
+    const uint8x16_t result = vqsubq_u8(vqaddq_u8(colors, vreinterpretq_u8_u32(add_words)),
+                                        vreinterpretq_u8_u32(sub_words));
+    vst1q_u8(reinterpret_cast<u8*>(palette), result);
+#endif
+#else
+    const auto apply = [&base](int modifier) {
+        return Common::MakeVec(static_cast<u8>(std::clamp(base.r() + modifier, 0, 255)),
+                               static_cast<u8>(std::clamp(base.g() + modifier, 0, 255)),
+                               static_cast<u8>(std::clamp(base.b() + modifier, 0, 255)), u8{0});
+    };
+    palette[0] = apply(small);
+    palette[1] = apply(large);
+    palette[2] = apply(-small);
+    palette[3] = apply(-large);
+#endif
+}
+
 } // anonymous namespace
 
 Common::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y) {
@@ -124,4 +202,35 @@ Common::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y) {
     return tile.GetRGB(x, y);
 }
 
+ETC1Block DecodeETC1Block(u64 value, u64 alpha) {
+    const ETC1Tile tile{value};
+
+    // Both subblocks have a single base color and modifier table, so the block uses at most
+    // eight distinct colors. Compute those once instead of clamping every texel.
+    Palette palette;
+    ComputeSubblockPalette(tile.GetBaseColor(0), etc1_modifier_table[tile.table_index_1],
+                           palette.data());
+    ComputeSubblockPalette(tile.GetBaseColor(1), etc1_modifier_table[tile.table_index_2],
+                           palette.data() + 4);
+
+    const u32 subindexes = static_cast<u32>(tile.table_subindexes.Value());
+    const u32 negations = static_cast<u32>(tile.negation_flags.Value());
+    const bool flip = tile.flip;
+
+    ETC1Block texels;
+    for (u32 y = 0; y < 4; y++) {
+        for (u32 x = 0; x < 4; x++) {
+            // Texel data is stored column major.
+            const u32 texel = 4 * x + y;
+            const u32 subblock = (flip ? y : x) >= 2;
+            const u32 index = (((negations >> texel) & 1) << 1) | ((subindexes >> texel) & 1);
+
+            Common::Vec4<u8>& dest = texels[y * 4 + x];
+            dest = palette[subblock * 4 + index];
+            dest.a() = Common::Color::Convert4To8((alpha >> (4 * texel)) & 0xF);
+        }
+    }
+    return texels;
+}
+
 } // namespace Pica::Texture
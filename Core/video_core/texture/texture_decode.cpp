@@ -19,6 +19,41 @@ namespace Pica::Texture {
 constexpr std::size_t TILE_SIZE = 8 * 8;
 constexpr std::size_t ETC1_SUBTILES = 2 * 2;
 
+namespace {
+
+/**
+ * Recently decoded ETC1 blocks of the calling thread. Neighbouring samples mostly fall in the same
+ * 4x4 block, so decoding it whole once is cheaper than decoding every texel on its own. Entries
+ * are keyed by the block contents, which keeps them valid when texture memory changes.
+ */
+struct ETC1BlockCache {
+    static constexpr std::size_t NUM_ENTRIES = 4;
+
+    struct Entry {
+        u64 value{};
+        u64 alpha{};
+        bool valid{};
+        ETC1Block texels;
+    };
+
+    const ETC1Block& Get(const u8* subtile_ptr, u64 value, u64 alpha) {
+        Entry& entry = entries[(reinterpret_cast<uintptr_t>(subtile_ptr) >> 3) % NUM_ENTRIES];
+        if (!entry.valid || entry.value != value || entry.alpha != alpha) {
+            entry.value = value;
+            entry.alpha = alpha;
+            entry.valid = true;
+            entry.texels = DecodeETC1Block(value, alpha);
+        }
+        return entry.texels;
+    }
+
+    std::array<Entry, NUM_ENTRIES> entries{};
+};
+
+thread_local ETC1BlockCache etc1_block_cache;
+
+} // Anonymous namespace
+
 size_t CalculateTileSize(TextureFormat format) {
     switch (format) {
     case TextureFormat::RGBA8:
@@ -187,21 +222,22 @@ Common::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned in
 
         const u8* subtile_ptr = source + subtile_index * subtile_size;
 
-        u8 alpha = 255;
+        const u8* block_ptr = subtile_ptr;
+        u64_le packed_alpha = ETC1_OPAQUE_ALPHA;
         if (has_alpha) {
-            u64_le packed_alpha;
             std::memcpy(&packed_alpha, subtile_ptr, sizeof(u64));
             subtile_ptr += sizeof(u64);
-
-            alpha =
-                Common::Color::Convert4To8((packed_alpha >> (4 * (x * subtile_width + y))) & 0xF);
         }
 
         u64_le subtile_data;
         std::memcpy(&subtile_data, subtile_ptr, sizeof(u64));
 
-        return Common::MakeVec(SampleETC1Subtile(subtile_data, x, y),
-                               disable_alpha ? (u8)255 : alpha);
+        auto texel =
+            etc1_block_cache.Get(block_ptr, subtile_data, packed_alpha)[y * subtile_width + x];
+        if (disable_alpha) {
+            texel.a() = 255;
+        }
+        return texel;
     }
 
     default: